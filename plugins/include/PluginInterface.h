@@ -37,6 +37,28 @@ extern "C" {
 29  Altitude from Average radius
 30  fsdJump
 31  srvHighBeam
+
+Flags2, stored after the 32 bits of Flags:
+32  OnFoot
+33  InTaxi (or dropship/shuttle)
+34  InMulticrew (ie in someone else's ship)
+35  OnFootInStation
+36  OnFootOnPlanet
+37  AimDownSight
+38  LowOxygen
+39  LowHealth
+40  Cold
+41  Hot
+42  VeryCold
+43  VeryHot
+44  Glide Mode
+45  OnFootInHangar
+46  OnFootSocialSpace
+47  OnFootExterior
+48  BreathableAtmosphere
+49  Telepresence Multicrew
+50  Physical Multicrew
+51  Fsd hyperdrive charging
 */
 
 // List of logged events
@@ -72,7 +94,27 @@ extern "C" {
     X(Night_Vision)                 \
     X(Altitude_from_Average_radius) \
     X(fsdJump)                      \
-    X(srvHighBeam)
+    X(srvHighBeam)                  \
+    X(On_Foot)                      \
+    X(In_Taxi)                      \
+    X(In_Multicrew)                 \
+    X(OnFoot_In_Station)            \
+    X(OnFoot_On_Planet)             \
+    X(Aim_Down_Sight)               \
+    X(Low_Oxygen)                   \
+    X(Low_Health)                   \
+    X(Cold)                         \
+    X(Hot)                          \
+    X(Very_Cold)                    \
+    X(Very_Hot)                     \
+    X(Glide_Mode)                   \
+    X(OnFoot_In_Hangar)             \
+    X(OnFoot_Social_Space)          \
+    X(OnFoot_Exterior)              \
+    X(Breathable_Atmosphere)        \
+    X(Telepresence_Multicrew)       \
+    X(Physical_Multicrew)           \
+    X(Fsd_Hyperdrive_Charging)
 
 enum StatusEvent {
 #define GEN_ENUM(name) name,
@@ -89,7 +131,7 @@ typedef void (*SetJournalPreviousEventFn)(const char* event, const char* jsonEnt
 typedef struct {
     LoadConfigFn                loadConfig;                 // Load a configuration file
     OnStatusChangedFn           onStatusChanged;            // Notify a new status change
-    SetJournalPreviousEventFn   setJournalPreviousEvent;    // Set the previous journal events known at loading (for stateful plugins)
+    SetJournalPreviousEventFn   setJournalPreviousEvent;    // Set the previous journal events known at loading, since the last game load (for stateful plugins)
     OnJournalEventFn            onJournalEvent;             // Notify a new journal event
     void* ctx;
     // Metadata
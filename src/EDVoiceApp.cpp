@@ -1,9 +1,14 @@
 ﻿#include "EDVoiceApp.h"
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 #ifdef _WIN32
 #else
     #include <sys/inotify.h>
+    #include <sys/epoll.h>
+    #include <sys/timerfd.h>
+    #include <sys/eventfd.h>
     #include <unistd.h>
     #include <limits.h>
 #endif
@@ -53,27 +58,13 @@ static void loadConfigVP(const char* filepath, void* ctx)
     reinterpret_cast<VoicePackManager*>(ctx)->loadConfig(filepath);
 }
 
-static void onStatusChangedVP(StatusEvent event, int set, void* ctx)
-{
-    reinterpret_cast<VoicePackManager*>(ctx)->onStatusChanged(event, set);
-}
-
-static void setJournalPreviousEventVP(const char* event, const char* jsonEntry, void* ctx)
-{
-    reinterpret_cast<VoicePackManager*>(ctx)->setJournalPreviousEvent(event, jsonEntry);
-}
-
-static void onJournalEventVP(const char* event, const char* jsonEntry, void* ctx)
-{
-    reinterpret_cast<VoicePackManager*>(ctx)->onJournalEvent(event, jsonEntry);
-}
-
 extern "C" {
     void registerPluginVP(VoicePackManager* voicepack, PluginCallbacks* callbacks) {
         callbacks->loadConfig = loadConfigVP;
-        callbacks->onStatusChanged = onStatusChangedVP;
-        callbacks->setJournalPreviousEvent = setJournalPreviousEventVP;
-        callbacks->onJournalEvent = onJournalEventVP;
+        // Status and journal events are given directly by the core listeners
+        callbacks->onStatusChanged = nullptr;
+        callbacks->setJournalPreviousEvent = nullptr;
+        callbacks->onJournalEvent = nullptr;
         callbacks->ctx = voicepack;
 
         std::strncpy(callbacks->name, "VoicePack", sizeof(callbacks->name) - 1);
@@ -91,6 +82,9 @@ EDVoiceApp::EDVoiceApp(
     const std::filesystem::path& config)
     : _statusWatcher(EliteFileUtil::getStatusFile(EliteFileUtil::getUserProfile()))
     , _journalWatcher(EliteFileUtil::getLatestJournal(EliteFileUtil::getUserProfile()))
+    , _voicepack(AudioSinkConfig::fromEnvironment())
+    , _voicepackJournalListener(_voicepack)
+    , _voicepackStatusListener(_voicepack)
 {
     // Load configuration
     if (!std::filesystem::exists(config)) {
@@ -119,6 +113,20 @@ EDVoiceApp::EDVoiceApp(
                     if (pluginItem.key() == "config") {
                         _config[item.key()] = basePath / pluginItem.value().get<std::string>();
                     }
+                    else if (pluginItem.key() == "queueSize") {
+                        _pluginQueueConfigs[item.key()].capacity = std::max<size_t>(1, pluginItem.value().get<size_t>());
+                    }
+                    else if (pluginItem.key() == "overflow") {
+                        const std::string policyName = pluginItem.value().get<std::string>();
+                        const std::optional<PluginQueueConfig::OverflowPolicy> policy = PluginQueueConfig::overflowFromString(policyName);
+
+                        if (policy) {
+                            _pluginQueueConfigs[item.key()].overflow = policy.value();
+                        }
+                        else {
+                            std::cerr << "[ERR   ] Unknown overflow policy for plugin " << item.key() << ": " << policyName << std::endl;
+                        }
+                    }
                 }
             }
         }
@@ -153,6 +161,10 @@ EDVoiceApp::EDVoiceApp(
     voice.versionStr = "0.3";
     registerPluginVP(&_voicepack, &voice.callbacks);
 
+    // Listeners are referenced by the plugin workers
+    _pluginJournalListeners.reserve(_plugins.size());
+    _pluginStatusListeners.reserve(_plugins.size());
+
     // Register plugins
     for (auto& plugin : _plugins) {
         // if configuration exists for this plugin, load it
@@ -164,27 +176,59 @@ EDVoiceApp::EDVoiceApp(
             plugin.callbacks.loadConfig(cfgPath.string().c_str(), plugin.callbacks.ctx);
         }
 
+        JournalListener* journalListener = nullptr;
+        StatusListener* statusListener = nullptr;
+
         if (plugin.callbacks.onJournalEvent) {
             std::cout << "[INFO  ] Registering journal listener for plugin " << plugin.name << std::endl;
             _pluginJournalListeners.push_back(PluginJournalListerner(&plugin.callbacks));
+            journalListener = &_pluginJournalListeners.back();
         }
         if (plugin.callbacks.onStatusChanged) {
             std::cout << "[INFO  ] Registering status listener for plugin " << plugin.name << std::endl;
             _pluginStatusListeners.push_back(PluginStatusListener(&plugin.callbacks));
+            statusListener = &_pluginStatusListeners.back();
+        }
+
+        if (journalListener || statusListener) {
+            PluginQueueConfig queueConfig;
+            auto itQueue = _pluginQueueConfigs.find(plugin.name);
+
+            if (itQueue != _pluginQueueConfigs.end()) {
+                queueConfig = itQueue->second;
+            }
+
+            _pluginWorkers.push_back(std::make_unique<PluginWorker>(plugin.name, journalListener, statusListener, queueConfig));
         }
     }
 
-    for (auto& listener : _pluginJournalListeners) {
-        _journalWatcher.addListener(&listener);
+    // The voicepack is served first on the dispatcher thread, then the
+    // plugins are fed through their own queue
+    _dispatcher.addJournalListener(&_voicepackJournalListener);
+    _dispatcher.addStatusListener(&_voicepackStatusListener);
+    _dispatcher.addStatusFieldListener(&_voicepackStatusListener, _voicepack.getStatusFields());
+
+    for (const StatusThreshold& threshold : _voicepack.getStatusThresholds()) {
+        _dispatcher.addStatusThreshold(&_voicepackStatusListener, threshold);
     }
 
-    for (auto& listener : _pluginStatusListeners) {
-        _statusWatcher.addListener(&listener);
+    for (auto& worker : _pluginWorkers) {
+        _dispatcher.addJournalListener(worker.get());
+        _dispatcher.addStatusListener(worker.get());
     }
 
-    // Prime watchers
+    _journalWatcher.addListener(&_dispatcher);
+    _statusWatcher.addListener(&_dispatcher);
+    _dispatcher.subscribeStatusFields(_statusWatcher);
+
+    // Prime watchers, synchronously
     _journalWatcher.start();
-    _statusWatcher.start();
+
+    for (auto& worker : _pluginWorkers) {
+        worker->start();
+    }
+
+    _dispatcher.start();
 
     // Start monitoring file change
 #ifdef _WIN32
@@ -195,7 +239,12 @@ EDVoiceApp::EDVoiceApp(
         this,
         _hStop);
 #else
-    _hStop = false;
+    _hStop = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (_hStop < 0) {
+        throw std::runtime_error("Cannot create the stop event");
+    }
+
     _watcherThread = std::thread(
         &EDVoiceApp::fileWatcherThread,
         this
@@ -206,20 +255,73 @@ EDVoiceApp::EDVoiceApp(
 
 EDVoiceApp::~EDVoiceApp()
 {
-    for (auto& plugin : _plugins) {
-        unloadPlugin(plugin);
+    // Stop dispatching events before unloading the plugins
+    requestStop();
+
+    if (_watcherThread.joinable()) {
+        _watcherThread.join();
+    }
+
+    _dispatcher.stop();
+
+    const DispatchStats stats = _dispatcher.getStats();
+    std::cout << "[INFO  ] Dispatched " << stats.dispatched << " events, "
+              << stats.overflows << " dropped, " << stats.coalesced << " coalesced, max queue depth " << stats.maxDepth << std::endl;
+
+    for (auto& worker : _pluginWorkers) {
+        worker->stop();
+
+        const PluginQueueStats workerStats = worker->getStats();
+        std::cout << "[INFO  ] Plugin " << worker->getName() << ": " << workerStats.processed << " events, "
+                  << workerStats.dropped << " dropped, " << workerStats.coalesced << " coalesced, max backlog " << workerStats.maxBacklog << std::endl;
+    }
+
+#ifdef USE_SDL_MIXER
+    const AudioCacheStats cacheStats = _voicepack.getAudioPlayer().getCacheStats();
+    std::cout << "[INFO  ] Audio cache: " << cacheStats.hits << " hits, " << cacheStats.misses << " misses, "
+              << cacheStats.evictions << " evictions, " << (cacheStats.bytes >> 20) << " / " << (cacheStats.budget >> 20) << " MB" << std::endl;
+#endif
+
+    const VoiceSchedulerStats schedulerStats = _voicepack.getAudioPlayer().getSchedulerStats();
+
+    if (schedulerStats.ingressDropped > 0) {
+        std::cout << "[INFO  ] Voicelines dropped on a full queue: " << schedulerStats.ingressDropped << std::endl;
+    }
+
+    for (size_t p = 0; p < N_VoicePriorities; p++) {
+        const VoicePriorityStats& stats = schedulerStats.priorities[p];
+
+        if (stats.played + stats.expired + stats.dropped > 0) {
+            std::cout << "[INFO  ] " << voicePriorityToString((VoicePriority)p) << " voicelines: " << stats.played << " played, "
+                      << stats.expired << " expired, " << stats.dropped << " dropped, " << stats.preempted << " preempted, wait "
+                      << stats.meanWaitMs() << " ms mean, " << stats.maxWaitMs << " ms max" << std::endl;
+        }
+    }
+
+    // Game event to playback latency
+    const LatencyReport latency = _voicepack.getAudioPlayer().getLatencyRecorder().getReport();
+
+    for (const LatencySummary& summary : latency.events) {
+        std::cout << "[INFO  ] Latency " << summary.name << ": " << summary.count << " voicelines, p50 " << summary.p50Ms
+                  << " ms, p95 " << summary.p95Ms << " ms, p99 " << summary.p99Ms << " ms, max " << summary.maxMs << " ms" << std::endl;
+    }
+
+    if (!latency.events.empty()) {
+        for (const LatencySummary& summary : latency.stages) {
+            std::cout << "[INFO  ] Latency " << summary.name << ": p50 " << summary.p50Ms << " ms, p95 " << summary.p95Ms
+                      << " ms, p99 " << summary.p99Ms << " ms, max " << summary.maxMs << " ms" << std::endl;
+        }
     }
 
 #ifdef _WIN32
-    SetEvent(_hStop);
-    _watcherThread.join();
     CloseHandle(_hStop);
 #else
-    _hStop = true;
-    if (_watcherThread.joinable()) {
-        _watcherThread.join();
-    }
+    close(_hStop);
 #endif
+
+    for (auto& plugin : _plugins) {
+        unloadPlugin(plugin);
+    }
 }
 
 
@@ -232,23 +334,33 @@ void EDVoiceApp::run()
 
 #ifdef _WIN32
         if (_kbhit()) {
-            SetEvent(_hStop);
-            std::cout << "Exiting..." << std::endl;
-            break;
-        }
 #else
         if (kbhit()) {
-            _hStop = true;
+#endif
+            requestStop();
             std::cout << "Exiting..." << std::endl;
             break;
         }
-#endif
     }
 
     std::cout << "Goodbye!" << std::endl;
 }
 
 
+void EDVoiceApp::requestStop()
+{
+#ifdef _WIN32
+    SetEvent(_hStop);
+#else
+    const uint64_t value = 1;
+
+    if (write(_hStop, &value, sizeof(value)) < 0) {
+        std::cerr << "[ERR   ] Cannot signal the file watcher to stop." << std::endl;
+    }
+#endif
+}
+
+
 #ifdef _WIN32
 void EDVoiceApp::fileWatcherThread(HANDLE hStop)
 {
@@ -289,7 +401,7 @@ void EDVoiceApp::fileWatcherThread(HANDLE hStop)
             buffer,
             sizeof(buffer),
             FALSE,
-            FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE,
+            FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_FILE_NAME,
             nullptr,
             &ov,
             nullptr
@@ -305,9 +417,16 @@ void EDVoiceApp::fileWatcherThread(HANDLE hStop)
     HANDLE handles[2] = { ov.hEvent, hStop };
 
     while (true) {
-        DWORD w = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
-
-        if (w == WAIT_OBJECT_0) {
+        // The game does not always flush its files to the disk: without
+        // notification, files are regularly read to catch missed changes.
+        DWORD w = WaitForMultipleObjects(2, handles, FALSE, FORCED_UPDATE_MS);
+        const LatencyTrace::Clock::time_point wakeTime = LatencyTrace::Clock::now();
+
+        if (w == WAIT_TIMEOUT) {
+            _statusWatcher.update(wakeTime);
+            _journalWatcher.update(wakeTime);
+        }
+        else if (w == WAIT_OBJECT_0) {
             // Read completed
             DWORD bytes = 0;
             if (!GetOverlappedResult(hDir, &ov, &bytes, FALSE)) {
@@ -332,11 +451,19 @@ void EDVoiceApp::fileWatcherThread(HANDLE hStop)
                 auto* fni = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(ptr);
                 std::wstring filename(fni->FileName, fni->FileNameLength / sizeof(WCHAR));
 
-                if (EliteFileUtil::isStatusFile(filename)) {
-                    _statusWatcher.update();
+                if (fni->Action == FILE_ACTION_REMOVED || fni->Action == FILE_ACTION_RENAMED_OLD_NAME) {
+                    // Nothing to read
+                }
+                else if (EliteFileUtil::isStatusFile(filename)) {
+                    _statusWatcher.update(wakeTime);
                 }
                 else if (EliteFileUtil::isJournalFile(filename)) {
-                    _journalWatcher.update(userProfile / filename);
+                    if (fni->Action == FILE_ACTION_ADDED || fni->Action == FILE_ACTION_RENAMED_NEW_NAME) {
+                        _journalWatcher.onJournalCreated(userProfile / filename, wakeTime);
+                    }
+                    else {
+                        _journalWatcher.update(wakeTime);
+                    }
                 }
                 else {
                     std::wcout << L"[INFO  ] Ignoring file change: " << filename << std::endl;
@@ -369,14 +496,14 @@ void EDVoiceApp::fileWatcherThread()
 {
     const std::filesystem::path userProfile = EliteFileUtil::getUserProfile();
 
-    const int inotifyFd = inotify_init1(IN_NONBLOCK);
+    const int inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
 
     if (inotifyFd < 0) {
         std::cerr << "[ERR   ] inotify_init1 failed." << std::endl;
         return;
     }
 
-    int watchFd = inotify_add_watch(inotifyFd, userProfile.c_str(), IN_MODIFY);
+    int watchFd = inotify_add_watch(inotifyFd, userProfile.c_str(), IN_MODIFY | IN_CREATE | IN_MOVED_TO);
 
     if (watchFd < 0) {
         std::cerr << "[ERR   ] inotify_add_watch failed on: " << userProfile << std::endl;
@@ -384,44 +511,111 @@ void EDVoiceApp::fileWatcherThread()
         return;
     }
 
+    // One shot timer, armed after each notification to catch data written
+    // without a notification. It stays disarmed while the game is quiet.
+    const int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    const int epollFd = epoll_create1(EPOLL_CLOEXEC);
+
+    if (timerFd < 0 || epollFd < 0) {
+        std::cerr << "[ERR   ] Cannot create the file watcher event loop." << std::endl;
+        if (timerFd >= 0) close(timerFd);
+        if (epollFd >= 0) close(epollFd);
+        inotify_rm_watch(inotifyFd, watchFd);
+        close(inotifyFd);
+        return;
+    }
+
+    for (int fd : { inotifyFd, timerFd, _hStop }) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    itimerspec refreshTimer{};
+    refreshTimer.it_value.tv_sec = FORCED_UPDATE_MS / 1000;
+    refreshTimer.it_value.tv_nsec = (FORCED_UPDATE_MS % 1000) * 1000000;
+
     constexpr size_t bufSize = 1024 * (sizeof(struct inotify_event) + NAME_MAX + 1);
-    char buffer[bufSize];
+    alignas(struct inotify_event) char buffer[bufSize];
+
+    bool stop = false;
 
-    while (!_hStop) {
-        const int length = read(inotifyFd, buffer, bufSize);
+    while (!stop) {
+        epoll_event events[3];
+        const int nEvents = epoll_wait(epollFd, events, 3, -1);
 
-        if (length < 0) {
-            if (errno == EAGAIN || errno == EINTR) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (nEvents < 0) {
+            if (errno == EINTR) {
                 continue;
             }
-            std::cerr << "[ERR   ] inotify read failed." << std::endl;
+            std::cerr << "[ERR   ] epoll_wait failed." << std::endl;
             break;
         }
 
-        int i = 0;
-        while (i < length) {
-            struct inotify_event* event = reinterpret_cast<struct inotify_event*>(&buffer[i]);
+        // Start of the latency traces of the events read on this wake up
+        const LatencyTrace::Clock::time_point wakeTime = LatencyTrace::Clock::now();
 
-            if (event->len > 0 && (event->mask & IN_MODIFY)) {
-                std::string filename(event->name);
-                std::filesystem::path fullpath = userProfile / filename;
+        for (int iEvent = 0; iEvent < nEvents; iEvent++) {
+            const int fd = events[iEvent].data.fd;
 
-                if (EliteFileUtil::isStatusFile(filename)) {
-                    _statusWatcher.update();
-                }
-                else if (EliteFileUtil::isJournalFile(filename)) {
-                    _journalWatcher.update(fullpath);
-                }
-                else {
-                    std::cout << "[INFO  ] Ignored file change: " << filename << std::endl;
-                }
+            if (fd == _hStop) {
+                stop = true;
+            }
+            else if (fd == timerFd) {
+                uint64_t expirations;
+                while (read(timerFd, &expirations, sizeof(expirations)) > 0) {}
+
+                _statusWatcher.update(wakeTime);
+                _journalWatcher.update(wakeTime);
             }
+            else if (fd == inotifyFd) {
+                // Drain all the pending notifications
+                while (true) {
+                    const ssize_t length = read(inotifyFd, buffer, bufSize);
+
+                    if (length <= 0) {
+                        if (length < 0 && errno != EAGAIN && errno != EINTR) {
+                            std::cerr << "[ERR   ] inotify read failed." << std::endl;
+                            stop = true;
+                        }
+                        break;
+                    }
+
+                    ssize_t i = 0;
+                    while (i < length) {
+                        struct inotify_event* event = reinterpret_cast<struct inotify_event*>(&buffer[i]);
+
+                        if (event->len > 0 && (event->mask & (IN_MODIFY | IN_CREATE | IN_MOVED_TO))) {
+                            std::string filename(event->name);
+
+                            if (EliteFileUtil::isStatusFile(filename)) {
+                                _statusWatcher.update(wakeTime);
+                            }
+                            else if (EliteFileUtil::isJournalFile(filename)) {
+                                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                                    _journalWatcher.onJournalCreated(userProfile / filename, wakeTime);
+                                }
+                                else {
+                                    _journalWatcher.update(wakeTime);
+                                }
+                            }
+                            else {
+                                std::cout << "[INFO  ] Ignored file change: " << filename << std::endl;
+                            }
+                        }
+
+                        i += sizeof(struct inotify_event) + event->len;
+                    }
+                }
 
-            i += sizeof(struct inotify_event) + event->len;
+                timerfd_settime(timerFd, 0, &refreshTimer, nullptr);
+            }
         }
     }
 
+    close(epollFd);
+    close(timerFd);
     inotify_rm_watch(inotifyFd, watchFd);
     close(inotifyFd);
 }
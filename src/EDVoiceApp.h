@@ -2,6 +2,7 @@
 
 #include <filesystem>
 #include <map>
+#include <memory>
 #include <thread>
 
 #include <PluginInterface.h>
@@ -22,6 +23,8 @@
 
 #include "watchers/StatusWatcher.h"
 #include "watchers/JournalWatcher.h"
+#include "dispatch/EventDispatcher.h"
+#include "dispatch/PluginWorker.h"
 
 // May be moved to a plugin later on
 #include "voicepack/VoicePackManager.h"
@@ -42,17 +45,25 @@ public:
     {
     }
 
-    void setJournalPreviousEvent(const std::string& event, const std::string& journalEntry) override
+    // Plugins cannot declare priming groups through the C interface
+    bool needsFullReplay() const override
+    {
+        return _callbacks && _callbacks->setJournalPreviousEvent;
+    }
+
+    void setJournalPreviousEvent(const JournalEvent& journalEvent, bool isPrimingEntry) override
     {
         if (_callbacks && _callbacks->setJournalPreviousEvent) {
-            _callbacks->setJournalPreviousEvent(event.c_str(), journalEntry.c_str(), _callbacks->ctx);
+            const std::string event(journalEvent.getEvent());
+            _callbacks->setJournalPreviousEvent(event.c_str(), journalEvent.getRaw().c_str(), _callbacks->ctx);
         }
     }
 
-    void onJournalEvent(const std::string& event, const std::string& journalEntry) override
+    void onJournalEvent(const JournalEvent& journalEvent) override
     {
         if (_callbacks && _callbacks->onJournalEvent) {
-            _callbacks->onJournalEvent(event.c_str(), journalEntry.c_str(), _callbacks->ctx);
+            const std::string event(journalEvent.getEvent());
+            _callbacks->onJournalEvent(event.c_str(), journalEvent.getRaw().c_str(), _callbacks->ctx);
         }
     }
 private:
@@ -60,6 +71,40 @@ private:
 };
 
 
+// The voicepack is a core component: it receives the parsed journal event
+// directly instead of going through the plugin C interface.
+class VoicePackJournalListener : public JournalListener
+{
+public:
+    VoicePackJournalListener(VoicePackManager& voicepack)
+        : _voicepack(voicepack)
+    {
+    }
+
+    std::vector<JournalPrimingGroup> getPrimingGroups() const override
+    {
+        return _voicepack.getPrimingGroups();
+    }
+
+    void setJournalPreviousEvent(const JournalEvent& journalEvent, bool isPrimingEntry) override
+    {
+        _voicepack.setJournalPreviousEvent(journalEvent);
+    }
+
+    void onJournalPrimingDone() override
+    {
+        _voicepack.onJournalPrimingDone();
+    }
+
+    void onJournalEvent(const JournalEvent& journalEvent) override
+    {
+        _voicepack.onJournalEvent(journalEvent);
+    }
+private:
+    VoicePackManager& _voicepack;
+};
+
+
 class PluginStatusListener : public StatusListener
 {
 public:
@@ -67,10 +112,14 @@ public:
         : _callbacks(callbacks)
     {
     }
-    void onStatusChanged(StatusEvent event, bool set) override
+    void onStatusChanged(StatusFlags flags, StatusFlags changedMask, const LatencyTrace& trace) override
     {
         if (_callbacks && _callbacks->onStatusChanged) {
-            _callbacks->onStatusChanged(event, set ? 1 : 0, _callbacks->ctx);
+            // The C interface stays one call per changed bit
+            while (changedMask) {
+                const StatusEvent event = StatusEventUtil::popLowest(changedMask);
+                _callbacks->onStatusChanged(event, StatusEventUtil::isSet(flags, event) ? 1 : 0, _callbacks->ctx);
+            }
         }
     }
 private:
@@ -78,6 +127,33 @@ private:
 };
 
 
+class VoicePackStatusListener : public StatusListener, public StatusFieldListener
+{
+public:
+    VoicePackStatusListener(VoicePackManager& voicepack)
+        : _voicepack(voicepack)
+    {
+    }
+
+    void onStatusChanged(StatusFlags flags, StatusFlags changedMask, const LatencyTrace& trace) override
+    {
+        _voicepack.onStatusChanged(flags, changedMask, trace);
+    }
+
+    void onStatusFieldsChanged(const StatusSnapshot& previous, const StatusSnapshot& current, StatusFieldMask changedMask) override
+    {
+        _voicepack.onStatusFieldsChanged(previous, current, changedMask);
+    }
+
+    void onStatusThreshold(const StatusThreshold& threshold, double value) override
+    {
+        _voicepack.onStatusThreshold(threshold, value);
+    }
+private:
+    VoicePackManager& _voicepack;
+};
+
+
 class EDVoiceApp
 {
 public:
@@ -89,6 +165,9 @@ public:
 
     VoicePackManager& getVoicepack() { return _voicepack; }
 
+    const EventDispatcher& getDispatcher() const { return _dispatcher; }
+    const std::vector<std::unique_ptr<PluginWorker>>& getPluginWorkers() const { return _pluginWorkers; }
+
 private:
 #ifdef _WIN32
     void fileWatcherThread(HANDLE hStop);
@@ -96,27 +175,40 @@ private:
     void fileWatcherThread();
 #endif
 
+    void requestStop();
+
     void loadPlugin(const std::filesystem::path& path);
     void unloadPlugin(LoadedPlugin& plugin);
 
 private:
+    // Fallback refresh of the watched files, for writes that were not notified
+    static constexpr int FORCED_UPDATE_MS = 100;
+
     std::map<std::string, std::filesystem::path> _config;
+    std::map<std::string, PluginQueueConfig> _pluginQueueConfigs;
     std::vector<LoadedPlugin> _plugins;
 
     std::vector<PluginJournalListerner> _pluginJournalListeners;
     std::vector<PluginStatusListener> _pluginStatusListeners;
+    std::vector<std::unique_ptr<PluginWorker>> _pluginWorkers;
 
     StatusWatcher _statusWatcher;
     JournalWatcher _journalWatcher;
 
+    // Listeners are called from the dispatcher thread, not the file watcher
+    EventDispatcher _dispatcher;
+
     // Now using voicepack as core application component
     VoicePackManager _voicepack;
+    VoicePackJournalListener _voicepackJournalListener;
+    VoicePackStatusListener _voicepackStatusListener;
 
     std::thread _watcherThread;
 
 #ifdef _WIN32
     HANDLE _hStop;
 #else
-    bool _hStop = false;
+    // eventfd, watched by the file watcher event loop
+    int _hStop = -1;
 #endif
 };
@@ -1,5 +1,7 @@
 ﻿#include "EDVoiceGUI.h"
 
+#include <algorithm>
+#include <cstdio>
 #include <stdexcept>
 #include <imgui.h>
 
@@ -45,6 +47,15 @@ void EDVoiceGUI::run()
 {
     while (!_mainWindow->closed())
     {
+        // Also when minimized, finished voicepack loads are published here
+        try {
+            _isLoadingVoicePack = _app.getVoicepack().pollVoicePackLoad();
+        }
+        catch (const std::runtime_error& e) {
+            _logErrStr = e.what();
+            _hasError = true;
+        }
+
         if (!_mainWindow->minimized()) {
             _mainWindow->beginFrame();
 
@@ -220,6 +231,11 @@ void EDVoiceGUI::voicePackGUI(bool allowOpenFile)
         ImGui::EndCombo();
     }
 
+    if (_isLoadingVoicePack) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("Loading...");
+    }
+
     if (allowOpenFile) {
         ImGui::SameLine();
 
@@ -228,6 +244,14 @@ void EDVoiceGUI::voicePackGUI(bool allowOpenFile)
         }
     }
 
+    const AudioLoadProgress loadProgress = voicepack.getAudioPlayer().getLoadProgress();
+
+    if (loadProgress.isLoading()) {
+        char overlay[64];
+        std::snprintf(overlay, sizeof(overlay), "Prefetching voicelines %zu / %zu", loadProgress.done, loadProgress.total);
+        ImGui::ProgressBar((float)loadProgress.done / (float)loadProgress.total, ImVec2(-1.f, 0.f), overlay);
+    }
+
     float volume = voicepack.getVolume();
     ImGui::SliderFloat("Volume", &volume, 0.f, 1.f, "%.2f");
 
@@ -235,6 +259,130 @@ void EDVoiceGUI::voicePackGUI(bool allowOpenFile)
         voicepack.setVolume(volume);
     }
 
+    if (ImGui::TreeNode("Voice mixing")) {
+        AudioPlayer& player = voicepack.getAudioPlayer();
+
+        for (size_t p = 0; p < N_VoicePriorities; p++) {
+            float gain = player.getPriorityGain((VoicePriority)p);
+
+            if (ImGui::SliderFloat(voicePriorityToString((VoicePriority)p), &gain, 0.f, 1.f, "%.2f")) {
+                player.setPriorityGain((VoicePriority)p, gain);
+            }
+        }
+
+        float overlayGain = player.getOverlayGain();
+
+        if (ImGui::SliderFloat("Overlays", &overlayGain, 0.f, 1.f, "%.2f")) {
+            player.setOverlayGain(overlayGain);
+        }
+
+#ifdef USE_SDL_MIXER
+        float duckingGain = player.getDuckingGain();
+
+        if (ImGui::SliderFloat("Ducking under critical lines", &duckingGain, 0.f, 1.f, "%.2f")) {
+            player.setDuckingGain(duckingGain);
+        }
+#endif
+
+        ImGui::TreePop();
+    }
+
+#ifdef USE_SDL_MIXER
+    int cacheBudgetMB = (int)voicepack.getCacheBudgetMB();
+
+    if (ImGui::InputInt("Audio cache (MB)", &cacheBudgetMB) && cacheBudgetMB > 0) {
+        voicepack.setCacheBudgetMB((size_t)cacheBudgetMB);
+    }
+
+    if (ImGui::TreeNode("Audio cache statistics")) {
+        const AudioCacheStats cacheStats = voicepack.getAudioPlayer().getCacheStats();
+
+        ImGui::Text("Clips: %zu (%.1f / %.1f MB, %.1f MB pinned)", cacheStats.clips,
+            cacheStats.bytes / 1048576.0, cacheStats.budget / 1048576.0, cacheStats.pinnedBytes / 1048576.0);
+        ImGui::Text("Hits: %llu  Misses: %llu  Evictions: %llu  Prefetches: %llu",
+            (unsigned long long)cacheStats.hits, (unsigned long long)cacheStats.misses,
+            (unsigned long long)cacheStats.evictions, (unsigned long long)cacheStats.prefetches);
+        ImGui::TreePop();
+    }
+#endif
+
+    if (ImGui::TreeNode("Voice scheduler statistics")) {
+        const VoiceSchedulerStats schedulerStats = voicepack.getAudioPlayer().getSchedulerStats();
+
+        ImGui::Text("Waiting: %zu, dropped on a full queue: %llu", schedulerStats.depth, (unsigned long long)schedulerStats.ingressDropped);
+
+        if (ImGui::BeginTable("Scheduler", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+            ImGui::TableSetupColumn("Priority");
+            ImGui::TableSetupColumn("Played");
+            ImGui::TableSetupColumn("Expired");
+            ImGui::TableSetupColumn("Dropped");
+            ImGui::TableSetupColumn("Preempted");
+            ImGui::TableSetupColumn("Mean wait (ms)");
+            ImGui::TableSetupColumn("Max wait (ms)");
+            ImGui::TableHeadersRow();
+
+            for (size_t p = 0; p < N_VoicePriorities; p++) {
+                const VoicePriorityStats& stats = schedulerStats.priorities[p];
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(voicePriorityToString((VoicePriority)p));
+                ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)stats.played);
+                ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)stats.expired);
+                ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)stats.dropped);
+                ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)stats.preempted);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", stats.meanWaitMs());
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", stats.maxWaitMs);
+            }
+
+            ImGui::EndTable();
+        }
+
+        ImGui::TreePop();
+    }
+
+    if (ImGui::TreeNode("Voiceline latency")) {
+        const LatencyReport latency = voicepack.getAudioPlayer().getLatencyRecorder().getReport();
+
+        auto latencyRow = [](const LatencySummary& summary) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(summary.name.c_str());
+            ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)summary.count);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", summary.p50Ms);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", summary.p95Ms);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", summary.p99Ms);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", summary.maxMs);
+        };
+
+        auto latencyTable = [&latencyRow](const char* id, const char* firstColumn, auto begin, auto end) {
+            if (ImGui::BeginTable(id, 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                ImGui::TableSetupColumn(firstColumn);
+                ImGui::TableSetupColumn("Count");
+                ImGui::TableSetupColumn("p50 (ms)");
+                ImGui::TableSetupColumn("p95 (ms)");
+                ImGui::TableSetupColumn("p99 (ms)");
+                ImGui::TableSetupColumn("Max (ms)");
+                ImGui::TableHeadersRow();
+
+                for (auto it = begin; it != end; it++) {
+                    latencyRow(*it);
+                }
+
+                ImGui::EndTable();
+            }
+        };
+
+        if (latency.events.empty()) {
+            ImGui::TextUnformatted("No voiceline played yet");
+        }
+        else {
+            // From the file notification to the playback
+            latencyTable("LatencyEvents", "Event", latency.events.begin(), latency.events.end());
+            latencyTable("LatencyStages", "Stage", latency.stages.begin(), latency.stages.end());
+        }
+
+        ImGui::TreePop();
+    }
+
 #ifdef BUILD_MEDICORP
     ImGui::Text("MediCorp Compliant: %s", _app.getVoicepack().isAltaCompliant() ? "Yes" : "No");
 #endif
@@ -258,6 +406,53 @@ void EDVoiceGUI::voicePackGUI(bool allowOpenFile)
         voicePackJourmalEventGUI();
         ImGui::PopID();
     }
+
+    if (ImGui::CollapsingHeader("Event dispatch")) {
+        ImGui::PushID("Dispatch");
+        dispatchStatsGUI();
+        ImGui::PopID();
+    }
+}
+
+
+void EDVoiceGUI::dispatchStatsGUI()
+{
+    const DispatchStats stats = _app.getDispatcher().getStats();
+
+    ImGui::Text("Dispatched: %llu, dropped: %llu, coalesced: %llu, queue depth: %zu (max %zu)",
+        (unsigned long long)stats.dispatched, (unsigned long long)stats.overflows, (unsigned long long)stats.coalesced, stats.depth, stats.maxDepth);
+
+    static ImGuiTableFlags flags = ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter;
+
+    if (ImGui::BeginTable("Plugins", 6, flags)) {
+        ImGui::TableSetupColumn("Plugin", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Overflow");
+        ImGui::TableSetupColumn("Backlog");
+        ImGui::TableSetupColumn("Processed");
+        ImGui::TableSetupColumn("Dropped");
+        ImGui::TableSetupColumn("Coalesced");
+        ImGui::TableHeadersRow();
+
+        for (const auto& worker : _app.getPluginWorkers()) {
+            const PluginQueueStats workerStats = worker->getStats();
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", worker->getName().c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", PluginQueueConfig::overflowToString(worker->getConfig().overflow));
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu / %zu (max %zu)", workerStats.backlog, worker->getConfig().capacity, workerStats.maxBacklog);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)workerStats.processed);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)workerStats.dropped);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)workerStats.coalesced);
+        }
+
+        ImGui::EndTable();
+    }
 }
 
 
@@ -332,7 +527,19 @@ void EDVoiceGUI::voicePackJourmalEventGUI()
 {
     VoicePackManager& voicepack = _app.getVoicepack();
 
-    const std::map<std::string, VoiceTriggerStatus>& eventItems = voicepack.getVoiceJournalActive();
+    const std::vector<VoiceTriggerStatus>& eventItems = voicepack.getVoiceJournalActive();
+    const JournalEventIds& journalIds = voicepack.getJournalEventIds();
+
+    // Ids follow the load order, listed by name
+    std::vector<JournalEventId> sortedEvents;
+
+    for (JournalEventId id = 0; id < eventItems.size(); id++) {
+        sortedEvents.push_back(id);
+    }
+
+    std::sort(sortedEvents.begin(), sortedEvents.end(), [&journalIds](JournalEventId a, JournalEventId b) {
+        return journalIds.getName(a) < journalIds.getName(b);
+    });
 
     static ImGuiTableFlags flags = ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter;
     uint32_t uid = 0;
@@ -342,8 +549,8 @@ void EDVoiceGUI::voicePackJourmalEventGUI()
         ImGui::TableSetupColumn("Event", ImGuiTableColumnFlags_WidthStretch);
         ImGui::TableHeadersRow();
 
-        for (const auto& voiceItem : eventItems) {
-            const VoiceTriggerStatus triggerStatus = voiceItem.second;
+        for (JournalEventId id : sortedEvents) {
+            const VoiceTriggerStatus triggerStatus = eventItems[id];
 
             if (triggerStatus != Undefined && triggerStatus != MissingFile) {
                 bool active = triggerStatus == Active;
@@ -356,11 +563,11 @@ void EDVoiceGUI::voicePackJourmalEventGUI()
                 ImGui::PopID();
 
                 if (active != (triggerStatus == Active)) {
-                    voicepack.setVoiceJournalState(voiceItem.first, active);
+                    voicepack.setVoiceJournalState(id, active);
                 }
 
                 ImGui::TableNextColumn();
-                ImGui::Text("%s", voiceItem.first.c_str());
+                ImGui::Text("%s", journalIds.getName(id).c_str());
             }
         }
 
@@ -465,6 +672,26 @@ const char* EDVoiceGUI::prettyPrintStatusState(StatusEvent status, bool activate
     case Altitude_from_Average_radius: return activated ? "Altitude from average radius" : "Altitude not from average radius";
     case fsdJump: return activated ? "FSD jumping" : "FSD jump ended";
     case srvHighBeam: return activated ? "SRV high beams enabled" : "SRV high beams disabled";
+    case On_Foot: return activated ? "Now on foot" : "No longer on foot";
+    case In_Taxi: return activated ? "Boarding taxi" : "Leaving taxi";
+    case In_Multicrew: return activated ? "Joining multicrew" : "Leaving multicrew";
+    case OnFoot_In_Station: return activated ? "On foot in station" : "Left station on foot";
+    case OnFoot_On_Planet: return activated ? "On foot on planet" : "Left planet surface on foot";
+    case Aim_Down_Sight: return activated ? "Aiming down sight" : "Stopped aiming down sight";
+    case Low_Oxygen: return activated ? "Low oxygen" : "Oxygen OK";
+    case Low_Health: return activated ? "Low health" : "Health OK";
+    case Cold: return activated ? "Cold" : "No longer cold";
+    case Hot: return activated ? "Hot" : "No longer hot";
+    case Very_Cold: return activated ? "Very cold" : "No longer very cold";
+    case Very_Hot: return activated ? "Very hot" : "No longer very hot";
+    case Glide_Mode: return activated ? "Glide mode engaged" : "Glide mode ended";
+    case OnFoot_In_Hangar: return activated ? "On foot in hangar" : "Left hangar on foot";
+    case OnFoot_Social_Space: return activated ? "On foot in social space" : "Left social space";
+    case OnFoot_Exterior: return activated ? "On foot outside" : "No longer on foot outside";
+    case Breathable_Atmosphere: return activated ? "Breathable atmosphere" : "Unbreathable atmosphere";
+    case Telepresence_Multicrew: return activated ? "Joining telepresence multicrew" : "Leaving telepresence multicrew";
+    case Physical_Multicrew: return activated ? "Joining physical multicrew" : "Leaving physical multicrew";
+    case Fsd_Hyperdrive_Charging: return activated ? "FSD hyperdrive charging" : "FSD hyperdrive not charging";
     case N_StatusEvents: return "Unknown";
     }
 
@@ -498,6 +725,8 @@ const char* EDVoiceGUI::prettyPrintSpecialEvent(SpecialEvent event)
     case HullIntegrity_Critical: return "Hull integrity critical";
     case AutoPilot_Liftoff: return "Autopilot liftoff";
     case AutoPilot_Touchdown: return "Autopilot touchdown";
+    case Fuel_Critical: return "Fuel critical";
+    case Oxygen_Critical: return "Oxygen critical";
     case N_SpecialEvents: return "Unknown";
     }
 
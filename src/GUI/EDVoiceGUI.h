@@ -33,6 +33,8 @@ private:
     void voicePackJourmalEventGUI();
     void voicePackSpecialEventGUI();
 
+    void dispatchStatsGUI();
+
     static void loadVoicePack(void* userdata, std::string path);
 
     static const char* prettyPrintStatusState(StatusEvent status, bool activated);
@@ -46,5 +48,6 @@ private:
     //WindowOverlay* _overlayWindow;
 
     bool _hasError = false;
+    bool _isLoadingVoicePack = false;
     std::string _logErrStr;
 };
\ No newline at end of file
@@ -87,7 +87,8 @@ void WindowBorderless::openVoicePackFileDialog(void* userdata, openedFile callba
 {
 #ifdef USE_SDL
     const SDL_DialogFileFilter filters[] = {
-    { "JSON file",  "json" }
+    { "JSON file",  "json" },
+    { "Voicepack bundle",  "edvpack" }
     };
 
     // TODO: Ugly but whatever... it is deleted by the callback
@@ -99,14 +100,14 @@ void WindowBorderless::openVoicePackFileDialog(void* userdata, openedFile callba
         sdlCallbackOpenFile,
         callbackData,
         _sdlWindow,
-        filters, 1,
+        filters, 2,
         NULL,
         false);
 #else
     const std::string newVoicePack = w32OpenFileName(
         "Select voicepack file",
         "",
-        "JSON file\0*.json\0",
+        "JSON file\0*.json\0Voicepack bundle\0*.edvpack\0",
         false);
 
     callback(userdata, newVoicePack);
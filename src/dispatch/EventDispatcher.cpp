@@ -0,0 +1,384 @@
+#include "EventDispatcher.h"
+
+#include <algorithm>
+#include <iostream>
+
+
+EventDispatcher::EventDispatcher(size_t capacity)
+    : _ring(capacity)
+{
+}
+
+
+EventDispatcher::~EventDispatcher()
+{
+    stop();
+}
+
+
+void EventDispatcher::addJournalListener(JournalListener* listener)
+{
+    _journalListeners.push_back(listener);
+}
+
+
+void EventDispatcher::addStatusListener(StatusListener* listener)
+{
+    _statusListeners.push_back(listener);
+}
+
+
+void EventDispatcher::addStatusFieldListener(StatusFieldListener* listener, StatusFieldMask fields)
+{
+    _fieldListeners.push_back({ listener, fields });
+}
+
+
+void EventDispatcher::addStatusThreshold(StatusFieldListener* listener, const StatusThreshold& threshold)
+{
+    _thresholds.push_back({ listener, threshold });
+}
+
+
+void EventDispatcher::subscribeStatusFields(StatusWatcher& watcher)
+{
+    StatusFieldMask fields = 0;
+
+    for (const FieldSubscription& subscription : _fieldListeners) {
+        fields |= subscription.fields;
+    }
+
+    if (fields) {
+        watcher.addFieldListener(this, fields);
+    }
+
+    // Once per distinct threshold, dispatched to all the listeners sharing it
+    for (size_t i = 0; i < _thresholds.size(); i++) {
+        bool isFirst = true;
+
+        for (size_t j = 0; j < i && isFirst; j++) {
+            isFirst = !(_thresholds[j].threshold == _thresholds[i].threshold);
+        }
+
+        if (isFirst) {
+            watcher.addThreshold(this, _thresholds[i].threshold);
+        }
+    }
+}
+
+
+void EventDispatcher::start()
+{
+    if (_running) {
+        return;
+    }
+
+    _running = true;
+    _thread = std::thread(&EventDispatcher::dispatchThread, this);
+}
+
+
+void EventDispatcher::stop()
+{
+    if (!_running) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+        _running = false;
+    }
+    _wakeCondition.notify_one();
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+
+DispatchStats EventDispatcher::getStats() const
+{
+    DispatchStats stats;
+
+    stats.pushed = _pushed;
+    stats.dispatched = _dispatched;
+    stats.overflows = _overflows;
+    stats.coalesced = _coalesced;
+    stats.depth = _ring.size();
+    stats.maxDepth = _maxDepth;
+
+    return stats;
+}
+
+
+std::vector<JournalPrimingGroup> EventDispatcher::getPrimingGroups() const
+{
+    std::vector<JournalPrimingGroup> groups;
+
+    for (JournalListener* listener : _journalListeners) {
+        const std::vector<JournalPrimingGroup> listenerGroups = listener->getPrimingGroups();
+        groups.insert(groups.end(), listenerGroups.begin(), listenerGroups.end());
+    }
+
+    return groups;
+}
+
+
+bool EventDispatcher::needsFullReplay() const
+{
+    for (JournalListener* listener : _journalListeners) {
+        if (listener->needsFullReplay()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void EventDispatcher::setJournalPreviousEvent(const JournalEvent& journalEvent, bool isPrimingEntry)
+{
+    for (JournalListener* listener : _journalListeners) {
+        if (isPrimingEntry || listener->needsFullReplay()) {
+            listener->setJournalPreviousEvent(journalEvent, isPrimingEntry);
+        }
+    }
+}
+
+
+void EventDispatcher::onJournalPrimingDone()
+{
+    for (JournalListener* listener : _journalListeners) {
+        listener->onJournalPrimingDone();
+    }
+}
+
+
+void EventDispatcher::onJournalEvent(const JournalEvent& journalEvent)
+{
+    DispatchItem item;
+    item.type = DispatchItem::Journal;
+    item.journalEvent = journalEvent.shared_from_this();
+
+    push(std::move(item));
+}
+
+
+void EventDispatcher::onStatusChanged(StatusFlags flags, StatusFlags changedMask, const LatencyTrace& trace)
+{
+    DispatchItem item;
+    item.type = DispatchItem::Status;
+    item.flags = flags;
+    item.changedMask = changedMask;
+    item.trace = trace;
+
+    push(std::move(item));
+}
+
+
+void EventDispatcher::onStatusFieldsChanged(const StatusSnapshot& previous, const StatusSnapshot& current, StatusFieldMask changedMask)
+{
+    DispatchItem item;
+    item.type = DispatchItem::StatusFields;
+    item.previous = previous;
+    item.current = current;
+    item.changedFields = changedMask;
+
+    push(std::move(item));
+}
+
+
+void EventDispatcher::onStatusThreshold(const StatusThreshold& threshold, double value)
+{
+    DispatchItem item;
+    item.type = DispatchItem::Threshold;
+    item.threshold = threshold;
+    item.value = value;
+
+    push(std::move(item));
+}
+
+
+void EventDispatcher::push(DispatchItem&& item)
+{
+    // Status items stay in order: once merged, the next ones are merged too
+    // until the dispatch thread takes them
+    const bool queued = (!_hasCoalesced || item.type == DispatchItem::Journal) && _ring.tryPush(std::move(item));
+
+    if (queued) {
+        _overflowing = false;
+        _pushed++;
+
+        const size_t depth = _ring.size();
+
+        if (depth > _maxDepth) {
+            _maxDepth = depth;
+        }
+    }
+    else if (coalesce(item)) {
+        _coalesced++;
+    }
+    else {
+        _overflows++;
+
+        // Log once per overflow burst
+        if (!_overflowing) {
+            std::cerr << "[WARN  ] Dispatch queue full, dropping journal events" << std::endl;
+            _overflowing = true;
+        }
+        return;
+    }
+
+    // Pairs with the fence in dispatchThread: either the dispatcher sees the
+    // new item, or we see it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (_sleeping) {
+        {
+            std::lock_guard<std::mutex> lock(_wakeMutex);
+        }
+        _wakeCondition.notify_one();
+    }
+}
+
+
+void EventDispatcher::dispatch(const DispatchItem& item)
+{
+    switch (item.type) {
+    case DispatchItem::Journal:
+        for (JournalListener* listener : _journalListeners) {
+            listener->onJournalEvent(*item.journalEvent);
+        }
+        break;
+    case DispatchItem::Status:
+        for (StatusListener* listener : _statusListeners) {
+            listener->onStatusChanged(item.flags, item.changedMask, item.trace);
+        }
+        break;
+    case DispatchItem::StatusFields:
+        for (const FieldSubscription& subscription : _fieldListeners) {
+            const StatusFieldMask fields = item.changedFields & subscription.fields;
+
+            if (fields) {
+                subscription.listener->onStatusFieldsChanged(item.previous, item.current, fields);
+            }
+        }
+        break;
+    case DispatchItem::Threshold:
+        for (const ThresholdSubscription& subscription : _thresholds) {
+            if (subscription.threshold == item.threshold) {
+                subscription.listener->onStatusThreshold(item.threshold, item.value);
+            }
+        }
+        break;
+    case DispatchItem::None:
+        break;
+    }
+
+    _dispatched++;
+}
+
+
+bool EventDispatcher::coalesce(DispatchItem& item)
+{
+    std::lock_guard<std::mutex> lock(_coalescedMutex);
+
+    switch (item.type) {
+    case DispatchItem::Status:
+        if (_coalescedStatus) {
+            // Bits changed twice cancel out, the oldest trace is kept
+            _coalescedStatus->changedMask ^= item.changedMask;
+            _coalescedStatus->flags = item.flags;
+        }
+        else {
+            _coalescedStatus = std::move(item);
+        }
+        break;
+    case DispatchItem::StatusFields:
+        if (_coalescedFields) {
+            // From the oldest snapshot to the newest
+            _coalescedFields->current = item.current;
+            _coalescedFields->changedFields |= item.changedFields;
+        }
+        else {
+            _coalescedFields = std::move(item);
+        }
+        break;
+    case DispatchItem::Threshold: {
+        auto it = std::find_if(_coalescedThresholds.begin(), _coalescedThresholds.end(), [&item](const DispatchItem& pending) {
+            return pending.threshold == item.threshold;
+        });
+
+        if (it != _coalescedThresholds.end()) {
+            it->value = item.value;
+        }
+        else {
+            _coalescedThresholds.push_back(std::move(item));
+        }
+        break;
+    }
+    case DispatchItem::Journal:
+    case DispatchItem::None:
+        return false;
+    }
+
+    _hasCoalesced = true;
+
+    return true;
+}
+
+
+void EventDispatcher::dispatchCoalesced()
+{
+    std::optional<DispatchItem> status;
+    std::optional<DispatchItem> fields;
+    std::vector<DispatchItem> thresholds;
+
+    {
+        std::lock_guard<std::mutex> lock(_coalescedMutex);
+
+        status.swap(_coalescedStatus);
+        fields.swap(_coalescedFields);
+        thresholds.swap(_coalescedThresholds);
+        _hasCoalesced = false;
+    }
+
+    if (status && status->changedMask) {
+        dispatch(*status);
+    }
+
+    if (fields) {
+        dispatch(*fields);
+    }
+
+    for (const DispatchItem& threshold : thresholds) {
+        dispatch(threshold);
+    }
+}
+
+
+void EventDispatcher::dispatchThread()
+{
+    DispatchItem item;
+
+    while (_running) {
+        while (_ring.tryPop(item)) {
+            dispatch(item);
+            item = DispatchItem();
+        }
+
+        // Newer than everything in the ring
+        if (_hasCoalesced) {
+            dispatchCoalesced();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_wakeMutex);
+
+        _sleeping = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        _wakeCondition.wait(lock, [this]() { return !_running || !_ring.empty() || _hasCoalesced; });
+        _sleeping = false;
+    }
+}
\ No newline at end of file
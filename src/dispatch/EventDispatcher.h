@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "../util/SpscRing.hpp"
+#include "../watchers/JournalWatcher.h"
+#include "../watchers/StatusWatcher.h"
+
+
+struct DispatchStats {
+    uint64_t pushed = 0;
+    uint64_t dispatched = 0;
+    uint64_t overflows = 0;
+    uint64_t coalesced = 0;
+    size_t depth = 0;
+    size_t maxDepth = 0;
+};
+
+
+// Decouples the file watcher thread from the listeners.
+// Registered as the only listener of the watchers, it queues the parsed
+// events in a lock-free ring and calls the actual listeners from its own
+// thread. When the ring is full, journal events are dropped instead of
+// stalling the file watcher, status changes are merged until the dispatch
+// thread catches up. Journal priming is forwarded synchronously.
+class EventDispatcher : public JournalListener, public StatusListener, public StatusFieldListener
+{
+public:
+    explicit EventDispatcher(size_t capacity = DEFAULT_CAPACITY);
+    virtual ~EventDispatcher();
+
+    // Listeners must be added before start()
+    void addJournalListener(JournalListener* listener);
+    void addStatusListener(StatusListener* listener);
+    void addStatusFieldListener(StatusFieldListener* listener, StatusFieldMask fields);
+    void addStatusThreshold(StatusFieldListener* listener, const StatusThreshold& threshold);
+
+    // Subscribes to the fields and thresholds of all the field listeners
+    void subscribeStatusFields(StatusWatcher& watcher);
+
+    void start();
+    void stop();
+
+    DispatchStats getStats() const;
+
+    // JournalListener, called by the file watcher thread
+    std::vector<JournalPrimingGroup> getPrimingGroups() const override;
+    bool needsFullReplay() const override;
+    void setJournalPreviousEvent(const JournalEvent& journalEvent, bool isPrimingEntry) override;
+    void onJournalPrimingDone() override;
+    void onJournalEvent(const JournalEvent& journalEvent) override;
+
+    // StatusListener, called by the file watcher thread
+    void onStatusChanged(StatusFlags flags, StatusFlags changedMask, const LatencyTrace& trace) override;
+
+    // StatusFieldListener, called by the file watcher thread
+    void onStatusFieldsChanged(const StatusSnapshot& previous, const StatusSnapshot& current, StatusFieldMask changedMask) override;
+    void onStatusThreshold(const StatusThreshold& threshold, double value) override;
+
+private:
+    struct DispatchItem {
+        enum Type {
+            None,
+            Journal,
+            Status,
+            StatusFields,
+            Threshold
+        };
+
+        Type type = None;
+        JournalEventPtr journalEvent;
+        StatusFlags flags = 0;
+        StatusFlags changedMask = 0;
+        LatencyTrace trace;
+
+        StatusSnapshot previous;
+        StatusSnapshot current;
+        StatusFieldMask changedFields = 0;
+        StatusThreshold threshold = {};
+        double value = 0.;
+    };
+
+    struct FieldSubscription {
+        StatusFieldListener* listener;
+        StatusFieldMask fields;
+    };
+
+    struct ThresholdSubscription {
+        StatusFieldListener* listener;
+        StatusThreshold threshold;
+    };
+
+    void push(DispatchItem&& item);
+    void dispatch(const DispatchItem& item);
+
+    // Merges a status item the ring has no room for, false for journal events
+    bool coalesce(DispatchItem& item);
+    void dispatchCoalesced();
+    void dispatchThread();
+
+private:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    std::vector<JournalListener*> _journalListeners;
+    std::vector<StatusListener*> _statusListeners;
+    std::vector<FieldSubscription> _fieldListeners;
+    std::vector<ThresholdSubscription> _thresholds;
+
+    SpscRing<DispatchItem> _ring;
+
+    std::thread _thread;
+    std::atomic<bool> _running = false;
+
+    // Only used to sleep when the ring is empty
+    std::mutex _wakeMutex;
+    std::condition_variable _wakeCondition;
+    std::atomic<bool> _sleeping = false;
+
+    std::atomic<uint64_t> _pushed = 0;
+    std::atomic<uint64_t> _dispatched = 0;
+    std::atomic<uint64_t> _overflows = 0;
+    std::atomic<uint64_t> _coalesced = 0;
+    std::atomic<size_t> _maxDepth = 0;
+    bool _overflowing = false;
+
+    // Status items that did not fit in the ring, newer than the ones in it.
+    // Flags and fields are merged into one item each, thresholds keep their
+    // last crossing. Only locked on overflow and once the ring is drained.
+    std::mutex _coalescedMutex;
+    std::optional<DispatchItem> _coalescedStatus;
+    std::optional<DispatchItem> _coalescedFields;
+    std::vector<DispatchItem> _coalescedThresholds;
+    std::atomic<bool> _hasCoalesced = false;
+};
\ No newline at end of file
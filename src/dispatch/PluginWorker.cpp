@@ -0,0 +1,190 @@
+#include "PluginWorker.h"
+
+#include <iostream>
+
+
+PluginWorker::PluginWorker(
+    const std::string& name,
+    JournalListener* journalListener,
+    StatusListener* statusListener,
+    const PluginQueueConfig& config)
+    : _name(name)
+    , _journalListener(journalListener)
+    , _statusListener(statusListener)
+    , _config(config)
+{
+}
+
+
+PluginWorker::~PluginWorker()
+{
+    stop();
+}
+
+
+void PluginWorker::start()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_running) {
+        return;
+    }
+
+    _running = true;
+    _thread = std::thread(&PluginWorker::workerThread, this);
+}
+
+
+void PluginWorker::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (!_running) {
+            return;
+        }
+
+        _running = false;
+    }
+
+    _itemAvailable.notify_one();
+    _spaceAvailable.notify_all();
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+
+PluginQueueStats PluginWorker::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    PluginQueueStats stats;
+    stats.backlog = _queue.size();
+    stats.maxBacklog = _maxBacklog;
+    stats.processed = _processed;
+    stats.dropped = _dropped;
+    stats.coalesced = _coalesced;
+
+    return stats;
+}
+
+
+void PluginWorker::setJournalPreviousEvent(const JournalEvent& journalEvent, bool isPrimingEntry)
+{
+    if (_journalListener) {
+        _journalListener->setJournalPreviousEvent(journalEvent, isPrimingEntry);
+    }
+}
+
+
+void PluginWorker::onJournalPrimingDone()
+{
+    if (_journalListener) {
+        _journalListener->onJournalPrimingDone();
+    }
+}
+
+
+void PluginWorker::onJournalEvent(const JournalEvent& journalEvent)
+{
+    if (_journalListener) {
+        WorkItem item;
+        item.journalEvent = journalEvent.shared_from_this();
+
+        push(std::move(item));
+    }
+}
+
+
+void PluginWorker::onStatusChanged(StatusFlags flags, StatusFlags changedMask, const LatencyTrace& trace)
+{
+    if (_statusListener) {
+        WorkItem item;
+        item.flags = flags;
+        item.changedMask = changedMask;
+
+        push(std::move(item));
+    }
+}
+
+
+void PluginWorker::push(WorkItem&& item)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (!_running) {
+        return;
+    }
+
+    if (_queue.size() >= _config.capacity) {
+        switch (_config.overflow) {
+        case PluginQueueConfig::Coalesce:
+            // Successive status changes merge into one: bits changed twice cancel out
+            if (!item.journalEvent && !_queue.back().journalEvent) {
+                WorkItem& last = _queue.back();
+                last.changedMask ^= item.changedMask;
+                last.flags = item.flags;
+                _coalesced++;
+                return;
+            }
+            [[fallthrough]];
+        case PluginQueueConfig::DropOldest:
+            if (_dropped == 0) {
+                std::cerr << "[WARN  ] Plugin " << _name << " is too slow, dropping events" << std::endl;
+            }
+            _queue.pop_front();
+            _dropped++;
+            break;
+        case PluginQueueConfig::Block:
+            _spaceAvailable.wait(lock, [this]() { return !_running || _queue.size() < _config.capacity; });
+
+            if (!_running) {
+                return;
+            }
+            break;
+        }
+    }
+
+    _queue.push_back(std::move(item));
+
+    if (_queue.size() > _maxBacklog) {
+        _maxBacklog = _queue.size();
+    }
+
+    lock.unlock();
+    _itemAvailable.notify_one();
+}
+
+
+void PluginWorker::workerThread()
+{
+    while (true) {
+        WorkItem item;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _itemAvailable.wait(lock, [this]() { return !_running || !_queue.empty(); });
+
+            if (!_running) {
+                break;
+            }
+
+            item = std::move(_queue.front());
+            _queue.pop_front();
+        }
+
+        _spaceAvailable.notify_one();
+
+        if (item.journalEvent) {
+            _journalListener->onJournalEvent(*item.journalEvent);
+        }
+        else if (item.changedMask) {
+            _statusListener->onStatusChanged(item.flags, item.changedMask, LatencyTrace());
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _processed++;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "../watchers/JournalWatcher.h"
+#include "../watchers/StatusWatcher.h"
+
+
+struct PluginQueueConfig {
+    // What to do with a new event when the plugin queue is full
+    enum OverflowPolicy {
+        DropOldest, // Discard the oldest queued event
+        Block,      // Wait for the plugin, slows down the dispatcher
+        Coalesce    // Merge status changes, drop the oldest event otherwise
+    };
+
+    OverflowPolicy overflow = DropOldest;
+    size_t capacity = 256;
+
+    static std::optional<OverflowPolicy> overflowFromString(const std::string& s)
+    {
+        if (s == "dropOldest") return DropOldest;
+        if (s == "block") return Block;
+        if (s == "coalesce") return Coalesce;
+        return std::nullopt;
+    }
+
+    static const char* overflowToString(OverflowPolicy policy)
+    {
+        switch (policy) {
+        case DropOldest: return "dropOldest";
+        case Block: return "block";
+        case Coalesce: return "coalesce";
+        }
+        return "Unknown";
+    }
+};
+
+
+struct PluginQueueStats {
+    size_t backlog = 0;
+    size_t maxBacklog = 0;
+    uint64_t processed = 0;
+    uint64_t dropped = 0;
+    uint64_t coalesced = 0;
+};
+
+
+// Runs the callbacks of one plugin on its own thread, behind a bounded queue,
+// so a slow plugin cannot delay the voicepack or the other plugins.
+// Priming is forwarded synchronously.
+class PluginWorker : public JournalListener, public StatusListener
+{
+public:
+    // Either listener may be null when the plugin does not handle those events
+    PluginWorker(
+        const std::string& name,
+        JournalListener* journalListener,
+        StatusListener* statusListener,
+        const PluginQueueConfig& config);
+
+    virtual ~PluginWorker();
+
+    PluginWorker(const PluginWorker&) = delete;
+    PluginWorker& operator=(const PluginWorker&) = delete;
+
+    void start();
+    void stop();
+
+    const std::string& getName() const { return _name; }
+    const PluginQueueConfig& getConfig() const { return _config; }
+    PluginQueueStats getStats() const;
+
+    bool needsFullReplay() const override { return _journalListener && _journalListener->needsFullReplay(); }
+    void setJournalPreviousEvent(const JournalEvent& journalEvent, bool isPrimingEntry) override;
+    void onJournalPrimingDone() override;
+    void onJournalEvent(const JournalEvent& journalEvent) override;
+
+    // Plugins are not traced
+    void onStatusChanged(StatusFlags flags, StatusFlags changedMask, const LatencyTrace& trace) override;
+
+private:
+    struct WorkItem {
+        JournalEventPtr journalEvent;   // null for status changes
+        StatusFlags flags = 0;
+        StatusFlags changedMask = 0;
+    };
+
+    void push(WorkItem&& item);
+    void workerThread();
+
+private:
+    const std::string _name;
+    JournalListener* _journalListener;
+    StatusListener* _statusListener;
+    const PluginQueueConfig _config;
+
+    std::deque<WorkItem> _queue;
+    mutable std::mutex _mutex;
+    std::condition_variable _itemAvailable;
+    std::condition_variable _spaceAvailable;
+    bool _running = false;
+
+    std::thread _thread;
+
+    size_t _maxBacklog = 0;
+    uint64_t _processed = 0;
+    uint64_t _dropped = 0;
+    uint64_t _coalesced = 0;
+};
\ No newline at end of file
@@ -0,0 +1,71 @@
+// Microbenchmarks of the hot paths, most against the code they replaced:
+//     EDVoice-bench [name...]
+// Runs all the benchmarks when no name is given.
+
+#include "Bench.h"
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#include <config.h>
+
+
+volatile uint64_t g_benchSink = 0;
+
+
+struct Benchmark {
+    const char* name;
+    void (*run)();
+};
+
+static const Benchmark BENCHMARKS[] = {
+    { "queue", benchQueue },
+    { "enum", benchEnum },
+    { "variants", benchVariants },
+#ifdef USE_SDL_MIXER
+    { "audio", benchAudio },
+#endif
+};
+
+
+void reportBench(const std::string& name, size_t operations, std::chrono::nanoseconds elapsed)
+{
+    const double nsPerOp = (double)elapsed.count() / (double)(operations ? operations : 1);
+
+    std::cout << "[INFO  ] " << std::left << std::setw(48) << name << std::right
+              << std::fixed << std::setprecision(1) << std::setw(10) << nsPerOp << " ns/op" << std::endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+    int ret = 0;
+
+    for (int i = 1; i < argc; i++) {
+        bool found = false;
+
+        for (const Benchmark& benchmark : BENCHMARKS) {
+            found |= std::strcmp(argv[i], benchmark.name) == 0;
+        }
+
+        if (!found) {
+            std::cerr << "[ERR   ] Unknown benchmark: " << argv[i] << std::endl;
+            ret = 1;
+        }
+    }
+
+    for (const Benchmark& benchmark : BENCHMARKS) {
+        bool selected = (argc == 1);
+
+        for (int i = 1; i < argc; i++) {
+            selected |= std::strcmp(argv[i], benchmark.name) == 0;
+        }
+
+        if (selected) {
+            benchmark.run();
+        }
+    }
+
+    return ret;
+}
\ No newline at end of file
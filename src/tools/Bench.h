@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+// Keeps a result alive so the compiler cannot drop the code computing it
+extern volatile uint64_t g_benchSink;
+
+template<typename T>
+inline void benchKeep(const T& value)
+{
+    g_benchSink = g_benchSink + (uint64_t)value;
+}
+
+
+class BenchTimer
+{
+public:
+    BenchTimer() : _start(std::chrono::steady_clock::now()) {}
+
+    std::chrono::nanoseconds elapsed() const { return std::chrono::steady_clock::now() - _start; }
+
+private:
+    std::chrono::steady_clock::time_point _start;
+};
+
+
+// Prints the time per operation
+void reportBench(const std::string& name, size_t operations, std::chrono::nanoseconds elapsed);
+
+
+// One per hot path, see Bench.cpp
+void benchQueue();
+void benchEnum();
+void benchVariants();
+void benchAudio();     // SDL_mixer only
\ No newline at end of file
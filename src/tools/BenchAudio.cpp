@@ -0,0 +1,69 @@
+// Player latency on the null sink, from addTrack to the track start
+
+#include "Bench.h"
+
+#include <config.h>
+
+#ifdef USE_SDL_MIXER
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../voicepack/AudioPlayer.h"
+
+
+static constexpr size_t AUDIO_LINES = 200;
+
+// 5 ms of stereo silence, over before the next line
+static constexpr size_t CLIP_FRAMES = 48000 / 200;
+static constexpr auto LINE_INTERVAL = std::chrono::milliseconds(20);
+
+
+void benchAudio()
+{
+    // Must outlive the player
+    const std::vector<float> pcm(CLIP_FRAMES * 2, 0.f);
+
+    AudioSinkConfig sink;
+    sink.type = AudioSinkNull;
+
+    AudioPlayer player(sink);
+    LatencyRecorder& recorder = player.getLatencyRecorder();
+
+    const AudioClipId clip = player.loadRawClip("bench", pcm.data(), pcm.size() * sizeof(float), SDL_AUDIO_F32, 2, 48000);
+
+    if (clip == INVALID_AUDIO_CLIP) {
+        return;
+    }
+
+    const uint32_t eventType = recorder.getEventType("bench");
+    std::chrono::nanoseconds addTrackTime{ 0 };
+
+    for (size_t i = 0; i < AUDIO_LINES; i++) {
+        VoiceRequest request;
+        request.clip = clip;
+        request.queuedAt = std::chrono::steady_clock::now();
+        request.trace.eventType = eventType;
+
+        // The stages before the player are not measured here
+        request.trace.stamp(Wake, request.queuedAt);
+        request.trace.stamp(Parsed, request.queuedAt);
+        request.trace.stamp(Decided, request.queuedAt);
+
+        BenchTimer timer;
+        player.addTrack(request);
+        addTrackTime += timer.elapsed();
+
+        std::this_thread::sleep_for(LINE_INTERVAL);
+    }
+
+    reportBench("audio/addTrack, null sink", AUDIO_LINES, addTrackTime);
+
+    const LatencySummary& started = recorder.getReport().stages[Enqueued];
+
+    std::cout << "[INFO  ] audio/enqueued to started, null sink: " << started.count << " voicelines, p50 " << started.p50Ms
+              << " ms, p95 " << started.p95Ms << " ms, p99 " << started.p99Ms << " ms, max " << started.maxMs << " ms" << std::endl;
+}
+
+#endif // USE_SDL_MIXER
\ No newline at end of file
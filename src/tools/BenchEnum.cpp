@@ -0,0 +1,88 @@
+// Name lookups: the compile-time perfect hashes against the compare chains they replaced
+
+#include "Bench.h"
+
+#include <vector>
+
+#include "../voicepack/Enum.h"
+#include "../watchers/StatusEvent.h"
+#include "../watchers/StatusField.h"
+
+
+static constexpr size_t LOOKUP_ROUNDS = 1 << 14;
+
+
+// The *FromString functions before the perfect hashes, kept as the reference
+static std::optional<StatusEvent> linearStatusEvent(std::string_view s)
+{
+#define GEN_IF(name) if (s == #name) return name;
+    STATUS_EVENTS(GEN_IF)
+#undef GEN_IF
+    return std::nullopt;
+}
+
+static std::optional<StatusField> linearStatusField(std::string_view s)
+{
+#define GEN_IF(name) if (s == #name) return name;
+    STATUS_FIELDS(GEN_IF)
+#undef GEN_IF
+    return std::nullopt;
+}
+
+static std::optional<SpecialEvent> linearSpecialEvent(std::string_view s)
+{
+#define GEN_IF(name) if (s == #name) return name;
+    ENUM_SPECIAL_EVENTS(GEN_IF)
+#undef GEN_IF
+    return std::nullopt;
+}
+
+
+// Every name once, plus keys of the same files that are not in the table
+template<typename Find>
+static void benchLookup(const std::string& name, std::vector<std::string> keys, Find find)
+{
+    for (const char* miss : { "timestamp", "event", "Flags", "Flags2", "Pips", "Fuel", "LegalState" }) {
+        keys.emplace_back(miss);
+    }
+
+    BenchTimer timer;
+
+    for (size_t round = 0; round < LOOKUP_ROUNDS; round++) {
+        for (const std::string& key : keys) {
+            const auto value = find(key);
+            benchKeep(value ? (int)*value + 1 : 0);
+        }
+    }
+
+    reportBench(name, LOOKUP_ROUNDS * keys.size(), timer.elapsed());
+}
+
+
+void benchEnum()
+{
+    const std::vector<std::string> statusEvents = {
+#define GEN_NAME(name) #name,
+        STATUS_EVENTS(GEN_NAME)
+#undef GEN_NAME
+    };
+
+    const std::vector<std::string> statusFields = {
+#define GEN_NAME(name) #name,
+        STATUS_FIELDS(GEN_NAME)
+#undef GEN_NAME
+    };
+
+    const std::vector<std::string> specialEvents = {
+#define GEN_NAME(name) #name,
+        ENUM_SPECIAL_EVENTS(GEN_NAME)
+#undef GEN_NAME
+    };
+
+    benchLookup("enum/StatusEvent compare chain", statusEvents, linearStatusEvent);
+    benchLookup("enum/StatusEvent perfect hash", statusEvents, StatusEventUtil::fromString);
+    benchLookup("enum/StatusField compare chain", statusFields, linearStatusField);
+    benchLookup("enum/StatusField perfect hash", statusFields, StatusFieldUtil::fromString);
+    benchLookup("enum/SpecialEvent compare chain", specialEvents, linearSpecialEvent);
+    benchLookup("enum/SpecialEvent perfect hash", specialEvents, specialEventFromString);
+}
\ No newline at end of file
@@ -0,0 +1,188 @@
+// Player ingress: the lock-free MPSC ring against the mutex queue it replaced
+
+#include "Bench.h"
+
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "../util/MpscRing.hpp"
+#include "../voicepack/VoiceScheduler.h"
+
+
+// The player queue before the MPSC ring, kept as the reference
+template<typename T>
+class AtomicQueue
+{
+public:
+    void push(const T& value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queque.push(value);
+    }
+
+    void pop()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queque.pop();
+    }
+
+    T front() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_queque.front();
+    }
+
+    bool empty() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_queque.empty();
+    }
+
+    bool has(const T& value) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::queue<T> copy = m_queque;
+        while (!copy.empty()) {
+            if (copy.front() == value) return true;
+            copy.pop();
+        }
+        return false;
+    }
+
+private:
+    std::queue<T> m_queque;
+    mutable std::mutex m_mutex;
+};
+
+
+// Same capacity as the player
+static constexpr size_t RING_CAPACITY = 64;
+static constexpr size_t HANDOFF_LINES = 1 << 20;
+static constexpr size_t DUPLICATE_CHECKS = 1 << 16;
+
+
+static VoiceRequest makeRequest(size_t i)
+{
+    VoiceRequest request;
+    request.clip = (AudioClipId)(i + 1);
+    return request;
+}
+
+
+// Producers push their share of the lines, the consumer takes them all
+template<typename Push, typename Pop>
+static std::chrono::nanoseconds handoff(size_t nProducers, Push push, Pop pop)
+{
+    BenchTimer timer;
+    std::vector<std::thread> producers;
+
+    for (size_t p = 0; p < nProducers; p++) {
+        producers.emplace_back([&push, nProducers, p]() {
+            for (size_t i = p; i < HANDOFF_LINES; i += nProducers) {
+                push(makeRequest(i));
+            }
+        });
+    }
+
+    size_t received = 0;
+    VoiceRequest request;
+
+    while (received < HANDOFF_LINES) {
+        if (pop(request)) {
+            benchKeep(request.clip);
+            received++;
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+
+    return timer.elapsed();
+}
+
+
+void benchQueue()
+{
+    for (size_t nProducers : { 1, 4 }) {
+        const std::string suffix = ", " + std::to_string(nProducers) + " producer(s)";
+
+        {
+            AtomicQueue<VoiceRequest> queue;
+
+            const std::chrono::nanoseconds elapsed = handoff(nProducers,
+                [&queue](const VoiceRequest& request) { queue.push(request); },
+                [&queue](VoiceRequest& request) {
+                    // As the player thread did
+                    if (queue.empty()) {
+                        return false;
+                    }
+                    request = queue.front();
+                    queue.pop();
+                    return true;
+                });
+
+            reportBench("queue/handoff AtomicQueue" + suffix, HANDOFF_LINES, elapsed);
+        }
+
+        {
+            MpscRing<VoiceRequest> ring(RING_CAPACITY);
+
+            const std::chrono::nanoseconds elapsed = handoff(nProducers,
+                [&ring](VoiceRequest request) {
+                    // The player drops a line when full, retried here to move the same count
+                    while (!ring.tryPush(std::move(request))) {
+                        std::this_thread::yield();
+                    }
+                },
+                [&ring](VoiceRequest& request) { return ring.tryPop(request); });
+
+            reportBench("queue/handoff MpscRing" + suffix, HANDOFF_LINES, elapsed);
+        }
+    }
+
+    // Duplicate detection of a new line against the waiting ones
+    for (size_t depth : { 8, 64 }) {
+        const std::string suffix = ", " + std::to_string(depth) + " waiting";
+        const VoiceRequest duplicate = makeRequest(depth - 1);
+
+        {
+            AtomicQueue<AudioClipId> queue;
+
+            for (size_t i = 0; i < depth; i++) {
+                queue.push(makeRequest(i).clip);
+            }
+
+            BenchTimer timer;
+
+            for (size_t i = 0; i < DUPLICATE_CHECKS; i++) {
+                benchKeep(queue.has(duplicate.clip));
+            }
+
+            reportBench("queue/duplicate AtomicQueue::has" + suffix, DUPLICATE_CHECKS, timer.elapsed());
+        }
+
+        {
+            VoiceScheduler scheduler(depth);
+            std::vector<VoiceRequest> discarded;
+
+            for (size_t i = 0; i < depth; i++) {
+                scheduler.push(makeRequest(i), discarded);
+            }
+
+            BenchTimer timer;
+
+            for (size_t i = 0; i < DUPLICATE_CHECKS; i++) {
+                discarded.clear();
+                benchKeep(scheduler.push(duplicate, discarded));
+            }
+
+            reportBench("queue/duplicate VoiceScheduler::push" + suffix, DUPLICATE_CHECKS, timer.elapsed());
+        }
+    }
+}
\ No newline at end of file
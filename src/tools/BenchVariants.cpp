@@ -0,0 +1,113 @@
+// Variant picks: the trigger table alias pick against the std::rand CDF scan it replaced
+
+#include "Bench.h"
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "../voicepack/VoiceTriggerTable.h"
+
+
+static constexpr size_t PICKS = 1 << 20;
+
+
+// A voiceline before the trigger table, kept as the reference
+class CdfVoiceLine
+{
+public:
+    explicit CdfVoiceLine(uint32_t nVariants)
+    {
+        float sum = 0.0f;
+
+        for (uint32_t i = 0; i < nVariants; i++) {
+            _clips.push_back((AudioClipId)(i + 1));
+            sum += 1.0f;
+            _cdf.push_back(sum);
+        }
+
+        for (auto& c : _cdf) {
+            c /= sum;
+        }
+    }
+
+    std::optional<VoiceRequest> getNextVoiceline()
+    {
+        const auto now = std::chrono::steady_clock::now();
+
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - _lastPlayed).count() < _cooldownMs) {
+            return {};
+        }
+
+        _lastPlayed = now;
+
+        VoiceRequest request;
+        request.priority = Normal;
+        request.ttlMs = DEFAULT_VOICE_TTL_MS[request.priority];
+        request.queuedAt = _lastPlayed;
+
+        const float sample = (float)std::rand() / (float)RAND_MAX;
+
+        for (size_t i = 0; i < _cdf.size(); i++) {
+            if (sample <= _cdf[i]) {
+                request.clip = _clips[i];
+                return request;
+            }
+        }
+
+        request.clip = _clips.back();
+        return request;
+    }
+
+private:
+    std::vector<AudioClipId> _clips;
+    std::vector<float> _cdf;
+    int _cooldownMs = 0;
+    std::chrono::steady_clock::time_point _lastPlayed;
+};
+
+
+void benchVariants()
+{
+    for (uint32_t nVariants : { 2, 8, 32 }) {
+        const std::string suffix = ", " + std::to_string(nVariants) + " variants";
+
+        {
+            CdfVoiceLine voiceline(nVariants);
+            BenchTimer timer;
+
+            for (size_t i = 0; i < PICKS; i++) {
+                benchKeep(voiceline.getNextVoiceline()->clip);
+            }
+
+            reportBench("variants/CDF scan" + suffix, PICKS, timer.elapsed());
+        }
+
+        {
+            std::vector<AudioClipId> clips;
+
+            for (uint32_t i = 0; i < nVariants; i++) {
+                clips.push_back((AudioClipId)(i + 1));
+            }
+
+            // Too large for the stack with all the status lines
+            std::unique_ptr<VoicePackLines> lines = std::make_unique<VoicePackLines>();
+            lines->journal.resize(1);
+            lines->journal[0].setVariants(std::vector<std::filesystem::path>(nVariants), {}, std::move(clips), 0);
+
+            VoiceTriggerTable table;
+            const VoiceTriggerTable::TriggerId trigger = VoiceTriggerTable::journalTrigger(0);
+
+            table.build(*lines, 0);
+            table.setActive(trigger, true);
+
+            BenchTimer timer;
+
+            for (size_t i = 0; i < PICKS; i++) {
+                benchKeep(table.trigger(trigger)->clip);
+            }
+
+            reportBench("variants/alias table" + suffix, PICKS, timer.elapsed());
+        }
+    }
+}
\ No newline at end of file
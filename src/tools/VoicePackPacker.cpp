@@ -0,0 +1,254 @@
+// Compiles a JSON voicepack and its audio files into a single bundle file:
+//     EDVoice-pack <voicepack.json> <output.edvpack>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <SDL3_mixer/SDL_mixer.h>
+
+#include "../voicepack/VoicePackBundle.h"
+#include "../voicepack/VoicePackJson.h"
+
+
+// Mixer native format, played without conversion
+static const SDL_AudioSpec BUNDLE_SPEC = { SDL_AUDIO_F32, 2, 48000 };
+
+
+class BundleWriter
+{
+public:
+    void addLine(BundleLine::Kind kind, const std::string& name, uint32_t vehicle, uint32_t state, VoiceLine& voiceline)
+    {
+        if (voiceline.empty()) {
+            return;
+        }
+
+        if (voiceline.removeMissingFiles()) {
+            std::cerr << "[ERR   ] Missing file for '" << name << "'" << std::endl;
+        }
+
+        BundleLine line = {};
+        line.kind = kind;
+        line.nameOffset = addString(name);
+        line.vehicle = vehicle;
+        line.state = state;
+        line.firstVariant = (uint32_t)_variants.size();
+        line.cooldownMs = voiceline.getCooldownMs();
+        line.ttlMs = voiceline.getTtlMs();
+        line.priority = (uint32_t)voiceline.getPriority().value_or(N_VoicePriorities);
+        line.flags = (voiceline.isOverlay() ? BundleLine::Overlay : 0) | (voiceline.isShuffle() ? BundleLine::Shuffle : 0);
+
+        const std::vector<std::filesystem::path>& files = voiceline.getFiles();
+        const std::vector<float>& probabilities = voiceline.getProbabilities();
+
+        for (size_t i = 0; i < files.size(); i++) {
+            const std::optional<uint32_t> clip = addClip(files[i]);
+
+            if (!clip) {
+                continue;
+            }
+
+            BundleVariant variant = {};
+            variant.clip = *clip;
+            variant.fileOffset = addString(files[i].filename().string());
+            variant.probability = (i < probabilities.size()) ? probabilities[i] : 1.f;
+
+            _variants.push_back(variant);
+        }
+
+        line.variantCount = (uint32_t)_variants.size() - line.firstVariant;
+
+        if (line.variantCount > 0) {
+            _lines.push_back(line);
+        }
+    }
+
+    void write(const std::filesystem::path& path)
+    {
+        BundleHeader header = {};
+        std::memcpy(header.magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC));
+        header.version = BUNDLE_VERSION;
+        header.audioFormat = (uint32_t)BUNDLE_SPEC.format;
+        header.channels = (uint32_t)BUNDLE_SPEC.channels;
+        header.freq = (uint32_t)BUNDLE_SPEC.freq;
+
+        header.lineCount = (uint32_t)_lines.size();
+        header.variantCount = (uint32_t)_variants.size();
+        header.clipCount = (uint32_t)_clips.size();
+        header.stringsSize = (uint32_t)_strings.size();
+
+        header.linesOffset = sizeof(BundleHeader);
+        header.variantsOffset = header.linesOffset + _lines.size() * sizeof(BundleLine);
+        header.clipsOffset = header.variantsOffset + _variants.size() * sizeof(BundleVariant);
+        header.stringsOffset = header.clipsOffset + _clips.size() * sizeof(BundleClip);
+        header.pcmOffset = align(header.stringsOffset + _strings.size());
+        header.fileSize = header.pcmOffset + _pcm.size();
+
+        // Written aside then renamed, a mapped bundle is never modified in place
+        std::filesystem::path tmpPath = path;
+        tmpPath += ".tmp";
+
+        {
+            std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+
+            if (!file) {
+                throw std::runtime_error("Cannot create " + tmpPath.string());
+            }
+
+            file.write((const char*)&header, sizeof(header));
+            file.write((const char*)_lines.data(), _lines.size() * sizeof(BundleLine));
+            file.write((const char*)_variants.data(), _variants.size() * sizeof(BundleVariant));
+            file.write((const char*)_clips.data(), _clips.size() * sizeof(BundleClip));
+            file.write(_strings.data(), _strings.size());
+
+            const std::vector<char> padding(header.pcmOffset - header.stringsOffset - _strings.size(), 0);
+            file.write(padding.data(), padding.size());
+            file.write((const char*)_pcm.data(), _pcm.size());
+
+            if (!file) {
+                throw std::runtime_error("Cannot write " + tmpPath.string());
+            }
+        }
+
+        std::filesystem::rename(tmpPath, path);
+
+        std::cout << "[INFO  ] Wrote " << _lines.size() << " voicelines, " << _clips.size() << " clips, "
+                  << (header.fileSize >> 10) << " KiB to " << path << std::endl;
+    }
+
+private:
+    static uint64_t align(uint64_t offset)
+    {
+        return (offset + BUNDLE_PCM_ALIGNMENT - 1) & ~(BUNDLE_PCM_ALIGNMENT - 1);
+    }
+
+    uint32_t addString(const std::string& s)
+    {
+        auto it = _stringOffsets.find(s);
+
+        if (it != _stringOffsets.end()) {
+            return it->second;
+        }
+
+        const uint32_t offset = (uint32_t)_strings.size();
+        _strings.insert(_strings.end(), s.begin(), s.end());
+        _strings.push_back('\0');
+        _stringOffsets[s] = offset;
+
+        return offset;
+    }
+
+    // Each file is decoded once, even if used by several lines
+    std::optional<uint32_t> addClip(const std::filesystem::path& path)
+    {
+        auto it = _clipIndices.find(path);
+
+        if (it != _clipIndices.end()) {
+            return it->second;
+        }
+
+        MIX_AudioDecoder* decoder = MIX_CreateAudioDecoder(path.string().c_str(), 0);
+
+        if (!decoder) {
+            std::cerr << "[ERR   ] Cannot decode " << path << ": " << SDL_GetError() << std::endl;
+            return std::nullopt;
+        }
+
+        BundleClip clip = {};
+        clip.offset = align(_pcm.size());
+        _pcm.resize(clip.offset);
+
+        uint8_t buffer[64 * 1024];
+        int read;
+
+        while ((read = MIX_DecodeAudio(decoder, buffer, sizeof(buffer), &BUNDLE_SPEC)) > 0) {
+            _pcm.insert(_pcm.end(), buffer, buffer + read);
+        }
+
+        MIX_DestroyAudioDecoder(decoder);
+
+        if (read < 0) {
+            std::cerr << "[ERR   ] Cannot decode " << path << ": " << SDL_GetError() << std::endl;
+            _pcm.resize(clip.offset);
+            return std::nullopt;
+        }
+
+        const size_t frameSize = BUNDLE_SPEC.channels * SDL_AUDIO_BYTESIZE(BUNDLE_SPEC.format);
+        clip.bytes = _pcm.size() - clip.offset;
+        clip.frames = clip.bytes / frameSize;
+
+        const uint32_t index = (uint32_t)_clips.size();
+        _clips.push_back(clip);
+        _clipIndices[path] = index;
+
+        return index;
+    }
+
+private:
+    std::vector<BundleLine> _lines;
+    std::vector<BundleVariant> _variants;
+    std::vector<BundleClip> _clips;
+    std::vector<char> _strings;
+    std::vector<uint8_t> _pcm;
+
+    std::map<std::string, uint32_t> _stringOffsets;
+    std::map<std::filesystem::path, uint32_t> _clipIndices;
+};
+
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <voicepack.json> <output" << BUNDLE_EXTENSION << ">" << std::endl;
+        return 1;
+    }
+
+    const std::filesystem::path inputPath = argv[1];
+    const std::filesystem::path outputPath = argv[2];
+
+    if (!MIX_Init()) {
+        std::cerr << "[ERR   ] " << SDL_GetError() << std::endl;
+        return 1;
+    }
+
+    int ret = 0;
+
+    try {
+        std::array<StatusVoiceLines, N_Vehicles> voiceStatus;
+        std::map<std::string, VoiceLine> voiceJournal;
+        std::array<VoiceLine, N_SpecialEvents> voiceSpecial;
+
+        VoicePackJson::load(inputPath, voiceStatus, voiceJournal, voiceSpecial);
+
+        BundleWriter writer;
+
+        // Vehicle overrides are already applied, one line per vehicle
+        for (uint32_t v = 0; v < N_Vehicles; v++) {
+            for (uint32_t i = 0; i < 2 * StatusEvent::N_StatusEvents; i++) {
+                writer.addLine(BundleLine::Status, statusToString((StatusEvent)(i / 2)), v, i % 2, voiceStatus[v][i]);
+            }
+        }
+
+        for (auto& [eventName, voiceline] : voiceJournal) {
+            writer.addLine(BundleLine::Journal, eventName, 0, 0, voiceline);
+        }
+
+        for (uint32_t i = 0; i < N_SpecialEvents; i++) {
+            writer.addLine(BundleLine::Special, specialEventToString((SpecialEvent)i), 0, 0, voiceSpecial[i]);
+        }
+
+        writer.write(outputPath);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[ERR   ] " << e.what() << std::endl;
+        ret = 1;
+    }
+
+    MIX_Quit();
+
+    return ret;
+}
\ No newline at end of file
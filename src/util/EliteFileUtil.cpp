@@ -8,9 +8,8 @@
 #include <pwd.h>
 #endif
 
-#ifdef min
-#undef min
-#endif
+#include <string>
+#include <string_view>
 
 bool EliteFileUtil::isJournalFile(const std::filesystem::path& path)
 {
@@ -24,21 +23,90 @@ bool EliteFileUtil::isJournalFile(const std::filesystem::path& path)
 }
 
 
+static bool appendDigits(std::string_view str, uint64_t& value)
+{
+    for (const char c : str) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + (c - '0');
+    }
+
+    return true;
+}
+
+
+std::optional<uint64_t> EliteFileUtil::getJournalKey(const std::filesystem::path& path)
+{
+    const std::string filename = path.filename().string();
+    std::string_view name(filename);
+
+    constexpr std::string_view prefix = "Journal.";
+    constexpr std::string_view suffix = ".log";
+
+    if (name.size() <= prefix.size() + suffix.size() ||
+        name.substr(0, prefix.size()) != prefix ||
+        name.substr(name.size() - suffix.size()) != suffix) {
+        return std::nullopt;
+    }
+
+    name = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+
+    // Timestamp and part number
+    const size_t dot = name.rfind('.');
+
+    if (dot == std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    const std::string_view stamp = name.substr(0, dot);
+    const std::string_view part = name.substr(dot + 1);
+
+    uint64_t key = 0;
+
+    if (stamp.size() == 17 && stamp[4] == '-' && stamp[7] == '-' && stamp[10] == 'T') {
+        // YYYY-MM-DDTHHMMSS
+        if (!appendDigits(stamp.substr(0, 4), key) ||
+            !appendDigits(stamp.substr(5, 2), key) ||
+            !appendDigits(stamp.substr(8, 2), key) ||
+            !appendDigits(stamp.substr(11, 6), key)) {
+            return std::nullopt;
+        }
+    }
+    else if (stamp.size() == 12) {
+        // YYMMDDHHMMSS, used before 2021
+        key = 20;
+
+        if (!appendDigits(stamp, key)) {
+            return std::nullopt;
+        }
+    }
+    else {
+        return std::nullopt;
+    }
+
+    uint64_t partNumber = 0;
+
+    if (part.empty() || part.size() > 2 || !appendDigits(part, partNumber)) {
+        return std::nullopt;
+    }
+
+    return key * 100 + partNumber;
+}
+
+
 std::filesystem::path EliteFileUtil::getLatestJournal(const std::filesystem::path& folder)
 {
+    // Journal names sort chronologically, no need to query the files
     std::filesystem::path latestFile;
-    std::filesystem::file_time_type latestTime = std::filesystem::file_time_type::min();
+    uint64_t latestKey = 0;
 
     for (const auto& entry : std::filesystem::directory_iterator(folder)) {
-        if (entry.is_regular_file()) {
-            if (isJournalFile(entry.path())) {
-                auto ftime = std::filesystem::last_write_time(entry);
-
-                if (ftime > latestTime) {
-                    latestTime = ftime;
-                    latestFile = entry.path();
-                }
-            }
+        const std::optional<uint64_t> key = getJournalKey(entry.path());
+
+        if (key && *key > latestKey) {
+            latestKey = *key;
+            latestFile = entry.path();
         }
     }
 
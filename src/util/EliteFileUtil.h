@@ -1,12 +1,18 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
+#include <optional>
 
 
 struct EliteFileUtil
 {
     static bool isJournalFile(const std::filesystem::path& path);
 
+    // Sort key from the journal file name: YYYYMMDDHHMMSS * 100 + part
+    // Handles Journal.YYYY-MM-DDTHHMMSS.01.log and the older Journal.YYMMDDHHMMSS.01.log
+    static std::optional<uint64_t> getJournalKey(const std::filesystem::path& path);
+
     static std::filesystem::path getLatestJournal(const std::filesystem::path& folder);
 
     static bool isStatusFile(const std::filesystem::path& path);
@@ -0,0 +1,134 @@
+#include "FileReader.h"
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/stat.h>
+    #include <cerrno>
+#endif
+
+
+FileReader::~FileReader()
+{
+    close();
+}
+
+
+#ifdef _WIN32
+bool FileReader::open(const std::filesystem::path& path)
+{
+    close();
+
+    _handle = CreateFileW(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+
+    return _handle != INVALID_HANDLE_VALUE;
+}
+
+
+void FileReader::close()
+{
+    if (_handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(_handle);
+        _handle = INVALID_HANDLE_VALUE;
+    }
+}
+
+
+bool FileReader::isOpen() const
+{
+    return _handle != INVALID_HANDLE_VALUE;
+}
+
+
+int64_t FileReader::readAt(uint64_t offset, char* buffer, size_t length) const
+{
+    if (_handle == INVALID_HANDLE_VALUE) {
+        return -1;
+    }
+
+    // On a synchronous handle, the OVERLAPPED offset is honored and the call blocks
+    OVERLAPPED ov{};
+    ov.Offset = (DWORD)(offset & 0xFFFFFFFFu);
+    ov.OffsetHigh = (DWORD)(offset >> 32);
+
+    DWORD bytesRead = 0;
+
+    if (!ReadFile(_handle, buffer, (DWORD)length, &bytesRead, &ov)) {
+        return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+    }
+
+    return bytesRead;
+}
+
+
+int64_t FileReader::size() const
+{
+    LARGE_INTEGER fileSize;
+
+    if (_handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(_handle, &fileSize)) {
+        return -1;
+    }
+
+    return fileSize.QuadPart;
+}
+#else
+bool FileReader::open(const std::filesystem::path& path)
+{
+    close();
+
+    _fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    return _fd >= 0;
+}
+
+
+void FileReader::close()
+{
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+}
+
+
+bool FileReader::isOpen() const
+{
+    return _fd >= 0;
+}
+
+
+int64_t FileReader::readAt(uint64_t offset, char* buffer, size_t length) const
+{
+    if (_fd < 0) {
+        return -1;
+    }
+
+    ssize_t bytesRead;
+
+    do {
+        bytesRead = ::pread(_fd, buffer, length, (off_t)offset);
+    } while (bytesRead < 0 && errno == EINTR);
+
+    return bytesRead;
+}
+
+
+int64_t FileReader::size() const
+{
+    struct stat st;
+
+    if (_fd < 0 || fstat(_fd, &st) != 0) {
+        return -1;
+    }
+
+    return st.st_size;
+}
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+
+#ifdef _WIN32
+    #include <windows.h>
+#endif
+
+
+// Read-only file handle doing positional reads (pread / ReadFile with offset).
+// The file is opened with full sharing so the game can keep writing to it.
+class FileReader
+{
+public:
+    FileReader() = default;
+    ~FileReader();
+
+    FileReader(const FileReader&) = delete;
+    FileReader& operator=(const FileReader&) = delete;
+
+    bool open(const std::filesystem::path& path);
+    void close();
+
+    bool isOpen() const;
+
+    // Returns the number of bytes read, 0 at end of file, -1 on error
+    int64_t readAt(uint64_t offset, char* buffer, size_t length) const;
+
+    // Returns -1 on error
+    int64_t size() const;
+
+private:
+#ifdef _WIN32
+    HANDLE _handle = INVALID_HANDLE_VALUE;
+#else
+    int _fd = -1;
+#endif
+};
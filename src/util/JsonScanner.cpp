@@ -0,0 +1,251 @@
+#include "JsonScanner.h"
+
+#include <charconv>
+
+
+JsonScanner::JsonScanner(std::string_view json)
+    : _json(json)
+{
+    skipWhitespaces();
+
+    if (_pos < _json.size() && (_json[_pos] == '{' || _json[_pos] == '[')) {
+        _isArray = (_json[_pos] == '[');
+        _pos++;
+        _valid = true;
+    }
+}
+
+
+bool JsonScanner::nextMember(std::string_view& key, std::string_view& rawValue)
+{
+    if (!_valid || _isArray) {
+        return false;
+    }
+
+    skipWhitespaces();
+
+    if (_pos < _json.size() && _json[_pos] == ',') {
+        _pos++;
+        skipWhitespaces();
+    }
+
+    if (_pos >= _json.size() || _json[_pos] != '"') {
+        // End of object or malformed input
+        _valid = false;
+        return false;
+    }
+
+    // Key
+    const size_t keyStart = _pos;
+
+    if (!skipString()) {
+        _valid = false;
+        return false;
+    }
+
+    key = _json.substr(keyStart + 1, _pos - keyStart - 2);
+
+    skipWhitespaces();
+
+    if (_pos >= _json.size() || _json[_pos] != ':') {
+        _valid = false;
+        return false;
+    }
+
+    _pos++;
+
+    return readValue(rawValue);
+}
+
+
+bool JsonScanner::nextElement(std::string_view& rawValue)
+{
+    if (!_valid || !_isArray) {
+        return false;
+    }
+
+    skipWhitespaces();
+
+    if (_pos < _json.size() && _json[_pos] == ',') {
+        _pos++;
+    }
+
+    return readValue(rawValue);
+}
+
+
+std::optional<std::string_view> JsonScanner::findMember(std::string_view json, std::string_view key)
+{
+    JsonScanner scanner(json);
+    std::string_view currKey, rawValue;
+
+    while (scanner.nextMember(currKey, rawValue)) {
+        if (currKey == key) {
+            return rawValue;
+        }
+    }
+
+    return std::nullopt;
+}
+
+
+std::optional<std::string_view> JsonScanner::toString(std::string_view rawValue)
+{
+    if (rawValue.size() < 2 || rawValue.front() != '"' || rawValue.back() != '"') {
+        return std::nullopt;
+    }
+
+    const std::string_view content = rawValue.substr(1, rawValue.size() - 2);
+
+    if (content.find('\\') != std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    return content;
+}
+
+
+std::optional<int64_t> JsonScanner::toInteger(std::string_view rawValue)
+{
+    int64_t value = 0;
+    const auto result = std::from_chars(rawValue.data(), rawValue.data() + rawValue.size(), value);
+
+    if (result.ec != std::errc() || result.ptr != rawValue.data() + rawValue.size()) {
+        return std::nullopt;
+    }
+
+    return value;
+}
+
+
+std::optional<uint64_t> JsonScanner::toUnsigned(std::string_view rawValue)
+{
+    uint64_t value = 0;
+    const auto result = std::from_chars(rawValue.data(), rawValue.data() + rawValue.size(), value);
+
+    if (result.ec != std::errc() || result.ptr != rawValue.data() + rawValue.size()) {
+        return std::nullopt;
+    }
+
+    return value;
+}
+
+
+std::optional<double> JsonScanner::toNumber(std::string_view rawValue)
+{
+    double value = 0.;
+    const auto result = std::from_chars(rawValue.data(), rawValue.data() + rawValue.size(), value);
+
+    if (result.ec != std::errc() || result.ptr != rawValue.data() + rawValue.size()) {
+        return std::nullopt;
+    }
+
+    return value;
+}
+
+
+bool JsonScanner::readValue(std::string_view& rawValue)
+{
+    skipWhitespaces();
+
+    // End of array or malformed input
+    if (_pos >= _json.size() || _json[_pos] == ']' || _json[_pos] == '}') {
+        _valid = false;
+        return false;
+    }
+
+    const size_t valueStart = _pos;
+
+    if (!skipValue()) {
+        _valid = false;
+        return false;
+    }
+
+    rawValue = _json.substr(valueStart, _pos - valueStart);
+
+    return true;
+}
+
+
+void JsonScanner::skipWhitespaces()
+{
+    while (_pos < _json.size() &&
+        (_json[_pos] == ' ' || _json[_pos] == '\t' || _json[_pos] == '\n' || _json[_pos] == '\r')) {
+        _pos++;
+    }
+}
+
+
+bool JsonScanner::skipString()
+{
+    // Opening quote
+    _pos++;
+
+    while (_pos < _json.size()) {
+        const char c = _json[_pos++];
+
+        if (c == '\\') {
+            _pos++;
+        }
+        else if (c == '"') {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool JsonScanner::skipValue()
+{
+    if (_pos >= _json.size()) {
+        return false;
+    }
+
+    const char c = _json[_pos];
+
+    if (c == '"') {
+        return skipString();
+    }
+
+    if (c == '{' || c == '[') {
+        int depth = 0;
+
+        while (_pos < _json.size()) {
+            const char curr = _json[_pos];
+
+            if (curr == '"') {
+                if (!skipString()) {
+                    return false;
+                }
+                continue;
+            }
+
+            if (curr == '{' || curr == '[') {
+                depth++;
+            }
+            else if (curr == '}' || curr == ']') {
+                depth--;
+            }
+
+            _pos++;
+
+            if (depth == 0) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Number, true, false or null
+    const size_t start = _pos;
+
+    while (_pos < _json.size() &&
+        _json[_pos] != ',' && _json[_pos] != '}' && _json[_pos] != ']' &&
+        _json[_pos] != ' ' && _json[_pos] != '\t' && _json[_pos] != '\n' && _json[_pos] != '\r') {
+        _pos++;
+    }
+
+    return _pos > start;
+}
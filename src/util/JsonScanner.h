@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+
+// Minimal allocation free JSON scanner.
+// Walks the members of one JSON object without building a DOM, values are
+// returned as views on the original bytes. Used on hot paths where only a
+// few fields are needed (journal event name, Status.json flags...).
+class JsonScanner
+{
+public:
+    // json must be a JSON object: '{' ... '}' or array: '[' ... ']'
+    explicit JsonScanner(std::string_view json);
+
+    // Returns false at the end of the object or on malformed input.
+    // rawValue is the unparsed value (quotes included for strings).
+    bool nextMember(std::string_view& key, std::string_view& rawValue);
+
+    // Same as nextMember, for arrays
+    bool nextElement(std::string_view& rawValue);
+
+    // Value of a top-level member, unparsed
+    static std::optional<std::string_view> findMember(std::string_view json, std::string_view key);
+
+    // Content of a string value, only for strings without escape sequences
+    static std::optional<std::string_view> toString(std::string_view rawValue);
+
+    static std::optional<int64_t> toInteger(std::string_view rawValue);
+    static std::optional<uint64_t> toUnsigned(std::string_view rawValue);
+    static std::optional<double> toNumber(std::string_view rawValue);
+
+private:
+    void skipWhitespaces();
+    bool skipString();
+    bool skipValue();
+    bool readValue(std::string_view& rawValue);
+
+    std::string_view _json;
+    size_t _pos = 0;
+    bool _valid = false;
+    bool _isArray = false;
+};
@@ -0,0 +1,182 @@
+#include "LatencyTrace.h"
+
+#include <algorithm>
+
+
+const char* latencyStageToString(LatencyStage stage)
+{
+    switch (stage) {
+#define GEN_CASE(name) case name: return #name;
+        ENUM_LATENCY_STAGES(GEN_CASE)
+#undef GEN_CASE
+    default: return "Unknown";
+    }
+}
+
+
+// ----------------------------------------------------------------------------
+// LatencyHistogram
+// ----------------------------------------------------------------------------
+
+uint32_t LatencyHistogram::bucketOf(uint64_t us)
+{
+    if (us < SUB_BUCKETS) {
+        return (uint32_t)us;
+    }
+
+    // Highest bit, then the next SUB_BUCKET_BITS bits below it
+    uint32_t exponent = 63;
+
+    while (!((us >> exponent) & 1)) {
+        exponent--;
+    }
+
+    const uint32_t shift = exponent - SUB_BUCKET_BITS;
+    const uint32_t sub = (uint32_t)(us >> shift) & (SUB_BUCKETS - 1);
+
+    return SUB_BUCKETS * (shift + 1) + sub;
+}
+
+
+uint64_t LatencyHistogram::bucketValue(uint32_t bucket)
+{
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+
+    // Middle of the bucket
+    const uint32_t shift = bucket / SUB_BUCKETS - 1;
+    const uint64_t sub = bucket % SUB_BUCKETS;
+    const uint64_t low = (SUB_BUCKETS + sub) << shift;
+
+    return low + (((uint64_t)1 << shift) >> 1);
+}
+
+
+void LatencyHistogram::add(uint64_t us)
+{
+    if (_buckets.empty()) {
+        _buckets.resize(N_BUCKETS, 0);
+    }
+
+    _buckets[bucketOf(us)]++;
+    _count++;
+
+    if (us > _max) {
+        _max = us;
+    }
+}
+
+
+uint64_t LatencyHistogram::getPercentile(double p) const
+{
+    if (_count == 0) {
+        return 0;
+    }
+
+    const uint64_t rank = (uint64_t)(p * (double)(_count - 1)) + 1;
+    uint64_t seen = 0;
+
+    for (uint32_t i = 0; i < N_BUCKETS; i++) {
+        seen += _buckets[i];
+
+        if (seen >= rank) {
+            return std::min(bucketValue(i), _max);
+        }
+    }
+
+    return _max;
+}
+
+
+// ----------------------------------------------------------------------------
+// LatencyRecorder
+// ----------------------------------------------------------------------------
+
+uint32_t LatencyRecorder::getEventType(std::string_view name)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const std::string key(name);
+    auto it = _eventTypeIds.find(key);
+
+    if (it != _eventTypeIds.end()) {
+        return it->second;
+    }
+
+    const uint32_t id = (uint32_t)_eventTypeNames.size();
+    _eventTypeIds[key] = id;
+    _eventTypeNames.push_back(key);
+    _events.emplace_back();
+
+    return id;
+}
+
+
+std::string LatencyRecorder::getEventTypeName(uint32_t eventType) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    return (eventType < _eventTypeNames.size()) ? _eventTypeNames[eventType] : std::string();
+}
+
+
+void LatencyRecorder::record(const LatencyTrace& trace)
+{
+    for (size_t i = 0; i < N_LatencyStages; i++) {
+        if (!trace.has((LatencyStage)i)) {
+            return;
+        }
+    }
+
+    auto elapsedUs = [&trace](LatencyStage from, LatencyStage to) {
+        const auto elapsed = trace.stamps[to] - trace.stamps[from];
+        return (uint64_t)std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    };
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (trace.eventType < _events.size()) {
+        _events[trace.eventType].add(elapsedUs(Wake, Started));
+    }
+
+    for (size_t i = 0; i + 1 < N_LatencyStages; i++) {
+        _stages[i].add(elapsedUs((LatencyStage)i, (LatencyStage)(i + 1)));
+    }
+}
+
+
+LatencySummary LatencyRecorder::summarize(const std::string& name, const LatencyHistogram& histogram)
+{
+    LatencySummary summary;
+
+    summary.name = name;
+    summary.count = histogram.getCount();
+    summary.p50Ms = histogram.getPercentile(0.50) / 1000.;
+    summary.p95Ms = histogram.getPercentile(0.95) / 1000.;
+    summary.p99Ms = histogram.getPercentile(0.99) / 1000.;
+    summary.maxMs = histogram.getMax() / 1000.;
+
+    return summary;
+}
+
+
+LatencyReport LatencyRecorder::getReport() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    LatencyReport report;
+
+    for (size_t i = 0; i < _events.size(); i++) {
+        if (_events[i].getCount() > 0) {
+            report.events.push_back(summarize(_eventTypeNames[i], _events[i]));
+        }
+    }
+
+    for (size_t i = 0; i + 1 < N_LatencyStages; i++) {
+        const std::string name = std::string(latencyStageToString((LatencyStage)i)) + " > " + latencyStageToString((LatencyStage)(i + 1));
+        report.stages[i] = summarize(name, _stages[i]);
+    }
+
+    return report;
+}
\ No newline at end of file
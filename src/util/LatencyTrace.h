@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+// Stages of an event: file watcher woken up, journal line or Status.json
+// decoded, voiceline chosen, handed to the audio player, playback started
+#define ENUM_LATENCY_STAGES(X) \
+    X(Wake) \
+    X(Parsed) \
+    X(Decided) \
+    X(Enqueued) \
+    X(Started)
+
+enum LatencyStage {
+#define GEN_ENUM(name) name,
+    ENUM_LATENCY_STAGES(GEN_ENUM)
+#undef GEN_ENUM
+    N_LatencyStages
+};
+
+const char* latencyStageToString(LatencyStage stage);
+
+
+// Timestamps of one event, carried along with it through the threads
+struct LatencyTrace {
+    typedef std::chrono::steady_clock Clock;
+
+    static constexpr uint32_t NO_EVENT_TYPE = UINT32_MAX;
+
+    std::array<Clock::time_point, N_LatencyStages> stamps{};
+    uint32_t eventType = NO_EVENT_TYPE;
+
+    void stamp(LatencyStage stage) { stamps[stage] = Clock::now(); }
+    void stamp(LatencyStage stage, Clock::time_point time) { stamps[stage] = time; }
+
+    bool has(LatencyStage stage) const { return stamps[stage] != Clock::time_point(); }
+};
+
+
+// Log-linear buckets in microseconds: 16 per power of two, about 6%
+// precision from 16 us to more than a minute
+class LatencyHistogram
+{
+public:
+    void add(uint64_t us);
+
+    uint64_t getCount() const { return _count; }
+    uint64_t getMax() const { return _max; }
+
+    // p in [0, 1], in microseconds
+    uint64_t getPercentile(double p) const;
+
+private:
+    static constexpr uint32_t SUB_BUCKET_BITS = 4;
+    static constexpr uint32_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr uint32_t N_BUCKETS = SUB_BUCKETS * (64 - SUB_BUCKET_BITS + 1);
+
+    static uint32_t bucketOf(uint64_t us);
+    static uint64_t bucketValue(uint32_t bucket);
+
+    std::vector<uint32_t> _buckets;
+    uint64_t _count = 0;
+    uint64_t _max = 0;
+};
+
+
+struct LatencySummary {
+    std::string name;
+    uint64_t count = 0;
+    double p50Ms = 0.;
+    double p95Ms = 0.;
+    double p99Ms = 0.;
+    double maxMs = 0.;
+};
+
+
+struct LatencyReport {
+    // From the wake up to the playback, per event type
+    std::vector<LatencySummary> events;
+
+    // Time spent between each stage and the next, all events together
+    std::array<LatencySummary, N_LatencyStages - 1> stages;
+};
+
+
+// Aggregates the traces of the voicelines played. Thread safe.
+class LatencyRecorder
+{
+public:
+    // Id of an event type, e.g. a journal event name
+    uint32_t getEventType(std::string_view name);
+    std::string getEventTypeName(uint32_t eventType) const;
+
+    // Only complete traces are recorded
+    void record(const LatencyTrace& trace);
+
+    LatencyReport getReport() const;
+
+private:
+    static LatencySummary summarize(const std::string& name, const LatencyHistogram& histogram);
+
+    std::unordered_map<std::string, uint32_t> _eventTypeIds;
+    std::vector<std::string> _eventTypeNames;
+    std::vector<LatencyHistogram> _events;
+    std::array<LatencyHistogram, N_LatencyStages - 1> _stages;
+
+    mutable std::mutex _mutex;
+};
\ No newline at end of file
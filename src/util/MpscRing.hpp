@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+
+// Bounded lock-free ring for any number of producer threads and exactly one
+// consumer thread. Each slot carries a sequence number telling whether it is
+// free for the producer of this lap or filled for the consumer.
+// Push never blocks: it fails when the ring is full.
+template<typename T>
+class MpscRing
+{
+public:
+    // Capacity is rounded up to a power of two
+    explicit MpscRing(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+
+        _slots = std::make_unique<Slot[]>(size);
+        _mask = size - 1;
+
+        for (size_t i = 0; i < size; i++) {
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // Any thread
+    bool tryPush(T&& value)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        while (true) {
+            slot = &_slots[tail & _mask];
+            const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = (intptr_t)sequence - (intptr_t)tail;
+
+            if (diff == 0) {
+                // Free for this lap, claim it
+                if (_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                // Not consumed yet since the previous lap
+                return false;
+            }
+            else {
+                // Claimed by another producer
+                tail = _tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->value = std::move(value);
+        slot->sequence.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // Consumer thread only
+    bool tryPop(T& value)
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        Slot& slot = _slots[head & _mask];
+
+        // A producer may have claimed the slot without filling it yet
+        if (slot.sequence.load(std::memory_order_acquire) != head + 1) {
+            return false;
+        }
+
+        value = std::move(slot.value);
+        slot.value = T();
+
+        slot.sequence.store(head + _mask + 1, std::memory_order_release);
+        _head.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // Approximate when called while other threads are active
+    size_t size() const
+    {
+        const size_t head = _head.load(std::memory_order_acquire);
+        const size_t tail = _tail.load(std::memory_order_acquire);
+
+        return (tail > head) ? tail - head : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    size_t capacity() const { return _mask + 1; }
+
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> _slots;
+    size_t _mask = 0;
+
+    // Consumer side
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> _head{ 0 };
+
+    // Producer side, shared by the producers
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> _tail{ 0 };
+};
\ No newline at end of file
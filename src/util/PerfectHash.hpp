@@ -0,0 +1,171 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+
+namespace PerfectHashUtil {
+    // FNV-1a
+    constexpr uint32_t hash(std::string_view s, uint32_t seed)
+    {
+        uint32_t h = 2166136261u ^ seed;
+
+        for (char c : s) {
+            h ^= (uint8_t)c;
+            h *= 16777619u;
+        }
+
+        return h;
+    }
+
+    constexpr uint32_t mix(uint32_t x)
+    {
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+
+        return x;
+    }
+
+    constexpr size_t bitsFor(size_t n)
+    {
+        size_t bits = 1;
+
+        while (((size_t)1 << bits) < n) {
+            bits++;
+        }
+
+        return bits;
+    }
+}
+
+
+// Maps the names of an X-macro enum to their value, built at compile time.
+// Hash and displace: the names are spread in buckets, each bucket has the
+// displacement that puts its names in free slots. A lookup hashes the
+// string once, reads two small tables and compares one name.
+// The names must be the values 0 to N - 1 of Enum, in order.
+template<typename Enum, size_t N>
+class PerfectHash
+{
+public:
+    explicit constexpr PerfectHash(const std::array<std::string_view, N>& names)
+        : _names(names)
+    {
+        for (uint32_t seed = 0; seed < MAX_SEEDS && !_valid; seed++) {
+            _seed = seed * 0x9e3779b9u;
+            _valid = build();
+        }
+    }
+
+    // False if no perfect hash was found, to check with a static_assert
+    constexpr bool isValid() const { return _valid; }
+
+    constexpr std::optional<Enum> find(std::string_view name) const
+    {
+        const uint16_t entry = _slots[slotOf(PerfectHashUtil::hash(name, _seed))];
+
+        if (entry != 0 && _names[entry - 1] == name) {
+            return (Enum)(entry - 1);
+        }
+
+        return std::nullopt;
+    }
+
+private:
+    // Twice as many slots as names, about two names per bucket
+    static constexpr size_t SLOT_BITS = PerfectHashUtil::bitsFor(2 * N);
+    static constexpr size_t N_SLOTS = (size_t)1 << SLOT_BITS;
+    static constexpr size_t N_BUCKETS = (N_SLOTS >= 4) ? N_SLOTS / 4 : 1;
+
+    static constexpr uint32_t MAX_SEEDS = 16;
+    static constexpr uint32_t MAX_DISPLACEMENT = 1024;
+
+    static_assert(N < UINT16_MAX, "Too many names");
+
+    constexpr size_t slotOf(uint32_t h) const
+    {
+        const uint32_t x = PerfectHashUtil::mix(h + _displacements[h & (N_BUCKETS - 1)] * 0x9e3779b9u);
+        return (size_t)(x >> (32 - SLOT_BITS));
+    }
+
+    constexpr bool build()
+    {
+        std::array<uint32_t, N> hashes{};
+        std::array<size_t, N_BUCKETS> counts{};
+        size_t maxCount = 0;
+
+        for (size_t i = 0; i < N_SLOTS; i++) {
+            _slots[i] = 0;
+        }
+
+        for (size_t i = 0; i < N; i++) {
+            hashes[i] = PerfectHashUtil::hash(_names[i], _seed);
+
+            const size_t count = ++counts[hashes[i] & (N_BUCKETS - 1)];
+            maxCount = (count > maxCount) ? count : maxCount;
+        }
+
+        // Largest buckets first, while most slots are free
+        for (size_t count = maxCount; count > 0; count--) {
+            for (size_t bucket = 0; bucket < N_BUCKETS; bucket++) {
+                if (counts[bucket] == count && !placeBucket(bucket, hashes)) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    constexpr bool placeBucket(size_t bucket, const std::array<uint32_t, N>& hashes)
+    {
+        for (uint32_t displacement = 0; displacement < MAX_DISPLACEMENT; displacement++) {
+            _displacements[bucket] = displacement;
+
+            size_t placed = 0;
+            bool fits = true;
+
+            for (size_t i = 0; i < N && fits; i++) {
+                if ((hashes[i] & (N_BUCKETS - 1)) != bucket) {
+                    continue;
+                }
+
+                const size_t slot = slotOf(hashes[i]);
+
+                if (_slots[slot] != 0) {
+                    fits = false;
+                }
+                else {
+                    _slots[slot] = (uint16_t)(i + 1);
+                    placed++;
+                }
+            }
+
+            if (fits) {
+                return true;
+            }
+
+            // Free the slots taken by this bucket with this displacement
+            for (size_t i = 0; i < N && placed > 0; i++) {
+                if ((hashes[i] & (N_BUCKETS - 1)) == bucket && _slots[slotOf(hashes[i])] == i + 1) {
+                    _slots[slotOf(hashes[i])] = 0;
+                    placed--;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    std::array<std::string_view, N> _names{};
+    std::array<uint16_t, N_SLOTS> _slots{};
+    std::array<uint32_t, N_BUCKETS> _displacements{};
+    uint32_t _seed = 0;
+    bool _valid = false;
+};
\ No newline at end of file
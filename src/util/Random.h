@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+
+// SplitMix64: small, fast and the same sequence on every platform for a
+// given seed, unlike std::rand and the std distributions. Not thread safe,
+// one instance per user.
+class Random
+{
+public:
+    explicit Random(uint64_t seed = 0) : _state(seed) {}
+
+    void seed(uint64_t seed) { _state = seed; }
+
+    uint64_t next()
+    {
+        uint64_t z = (_state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    // In [0, n), n > 0
+    uint32_t nextBelow(uint32_t n)
+    {
+        return (uint32_t)(((next() >> 32) * n) >> 32);
+    }
+
+    // In [0, 1)
+    float nextFloat()
+    {
+        return (float)(next() >> 40) * (1.f / (float)(1 << 24));
+    }
+
+private:
+    uint64_t _state;
+};
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+// Bounded lock-free ring for exactly one producer thread and one consumer
+// thread. Push never blocks: it fails when the ring is full.
+template<typename T>
+class SpscRing
+{
+public:
+    // Capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+
+        _buffer.resize(size);
+        _mask = size - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer thread only
+    bool tryPush(T&& value)
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+
+        if (tail - _cachedHead == _buffer.size()) {
+            _cachedHead = _head.load(std::memory_order_acquire);
+
+            if (tail - _cachedHead == _buffer.size()) {
+                return false;
+            }
+        }
+
+        _buffer[tail & _mask] = std::move(value);
+        _tail.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // Consumer thread only
+    bool tryPop(T& value)
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+
+        if (head == _cachedTail) {
+            _cachedTail = _tail.load(std::memory_order_acquire);
+
+            if (head == _cachedTail) {
+                return false;
+            }
+        }
+
+        T& slot = _buffer[head & _mask];
+        value = std::move(slot);
+        // Release resources held by the slot now rather than on the next lap
+        slot = T();
+
+        _head.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // Approximate when called while the other thread is active
+    size_t size() const
+    {
+        const size_t head = _head.load(std::memory_order_acquire);
+        const size_t tail = _tail.load(std::memory_order_acquire);
+
+        return tail - head;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    size_t capacity() const { return _buffer.size(); }
+
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    std::vector<T> _buffer;
+    size_t _mask = 0;
+
+    // Consumer side
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> _head{ 0 };
+    size_t _cachedTail = 0;
+
+    // Producer side
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> _tail{ 0 };
+    size_t _cachedHead = 0;
+};
\ No newline at end of file
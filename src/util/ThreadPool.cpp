@@ -0,0 +1,136 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+
+// Index of the pool worker running on this thread, to submit nested tasks locally
+static thread_local const ThreadPool* tlsPool = nullptr;
+static thread_local size_t tlsWorkerIndex = 0;
+
+
+ThreadPool::ThreadPool(size_t nThreads)
+{
+    if (nThreads == 0) {
+        nThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    for (size_t i = 0; i < nThreads; i++) {
+        _queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    for (size_t i = 0; i < nThreads; i++) {
+        _threads.emplace_back(&ThreadPool::workerThread, this, i);
+    }
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    stop();
+}
+
+
+void ThreadPool::submit(Task&& task)
+{
+    size_t index;
+
+    if (tlsPool == this) {
+        index = tlsWorkerIndex;
+    }
+    else {
+        index = _nextQueue++ % _queues.size();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+        _queues[index]->tasks.push_back(std::move(task));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+        _queuedTasks++;
+    }
+    _wakeCondition.notify_one();
+}
+
+
+void ThreadPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+
+        if (_stop) {
+            return;
+        }
+
+        _stop = true;
+    }
+    _wakeCondition.notify_all();
+
+    for (std::thread& thread : _threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    for (auto& queue : _queues) {
+        queue->tasks.clear();
+    }
+}
+
+
+void ThreadPool::workerThread(size_t index)
+{
+    tlsPool = this;
+    tlsWorkerIndex = index;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_wakeMutex);
+            _wakeCondition.wait(lock, [this]() { return _stop || _queuedTasks > 0; });
+
+            if (_stop) {
+                break;
+            }
+
+            // A task is in one of the queues for each claim
+            _queuedTasks--;
+        }
+
+        Task task;
+
+        if (popTask(index, task)) {
+            task();
+        }
+    }
+}
+
+
+bool ThreadPool::popTask(size_t index, Task& task)
+{
+    // Own queue, newest first
+    {
+        WorkerQueue& queue = *_queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // Steal the oldest task of another worker
+    for (size_t i = 1; i < _queues.size(); i++) {
+        WorkerQueue& queue = *_queues[(index + i) % _queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Fixed size pool with one task deque per worker. A worker takes its newest
+// task first and steals the oldest task of the other workers when idle.
+class ThreadPool
+{
+public:
+    typedef std::function<void()> Task;
+
+    // 0: one worker per core
+    explicit ThreadPool(size_t nThreads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(Task&& task);
+
+    // Joins the workers, queued tasks are discarded
+    void stop();
+
+    size_t getThreadCount() const { return _threads.size(); }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerThread(size_t index);
+    bool popTask(size_t index, Task& task);
+
+private:
+    std::vector<std::unique_ptr<WorkerQueue>> _queues;
+    std::vector<std::thread> _threads;
+
+    std::atomic<size_t> _nextQueue{ 0 };
+
+    // Under _wakeMutex. Tasks in the queues not claimed by a worker yet:
+    // counted once queued, a worker claims one before popping it.
+    std::mutex _wakeMutex;
+    std::condition_variable _wakeCondition;
+    size_t _queuedTasks = 0;
+    bool _stop = false;
+};
\ No newline at end of file
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstdint>
+
+// Handle on an audio clip loaded by the AudioPlayer
+typedef uint32_t AudioClipId;
+
+constexpr AudioClipId INVALID_AUDIO_CLIP = 0;
\ No newline at end of file
@@ -1,99 +1,787 @@
 #include "AudioPlayer.h"
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <thread>
 
 #include <config.h>
 
+// ----------------------------------------------------------------------------
+// Voiceline scheduling, common to both backends
+// ----------------------------------------------------------------------------
+
+bool AudioPlayer::pushRequest(const VoiceRequest& request)
+{
+    VoiceRequest queued = request;
+    queued.trace.stamp(Enqueued);
+
+    if (!_ingress.tryPush(std::move(queued))) {
+        // Log once per overflow burst
+        if (!_ingressOverflowing.exchange(true)) {
+            std::cerr << "[WARN  ] Voiceline queue full, dropping voicelines" << std::endl;
+        }
+
+        _ingressDropped++;
+        return false;
+    }
+
+    _ingressOverflowing = false;
+
+    return true;
+}
+
+
+bool AudioPlayer::drainRequests(std::vector<VoiceRequest>& discarded, std::vector<VoiceRequest>* overlays)
+{
+    bool critical = false;
+    VoiceRequest popped;
+    std::vector<VoiceRequest> incoming;
+
+#ifdef USE_SDL_MIXER
+    // Held lines arrived before the new ones
+    incoming.swap(_decoding);
+#endif
+
+    while (_ingress.tryPop(popped)) {
+        incoming.push_back(popped);
+    }
+
+    for (const VoiceRequest& request : incoming) {
+#ifdef USE_SDL_MIXER
+        const ClipState state = getClipState(request.clip);
+
+        if (state == ClipFailed) {
+            discarded.push_back(request);
+            continue;
+        }
+
+        // Still decoding, the pool wakes the scheduler up once done
+        if (state != ClipReady) {
+            _decoding.push_back(request);
+            continue;
+        }
+#endif
+
+        if (request.overlay && overlays) {
+            overlays->push_back(request);
+        }
+        else if (_scheduler.push(request, discarded) && request.priority == Critical) {
+            critical = true;
+        }
+    }
+
+    return critical;
+}
+
+
+float AudioPlayer::getPriorityGain(VoicePriority priority) const
+{
+    return _priorityGain[priority];
+}
+
+
+float AudioPlayer::getOverlayGain() const
+{
+    return _overlayGain;
+}
+
+
+float AudioPlayer::getDuckingGain() const
+{
+    return _duckingGain;
+}
+
+
+VoiceSchedulerStats AudioPlayer::getSchedulerStats() const
+{
+    std::lock_guard<std::mutex> lock(_trackMutex);
+
+    VoiceSchedulerStats stats = _scheduler.getStats();
+    stats.ingressDropped = _ingressDropped;
+
+    return stats;
+}
+
+
 #ifdef USE_SDL_MIXER
 
 #include <SDL3_mixer/SDL_mixer.h>
 
-AudioPlayer::AudioPlayer()
+AudioPlayer::AudioPlayer(const AudioSinkConfig& sink)
 {
     if (!MIX_Init()) {
         throw std::runtime_error(SDL_GetError());
     }
 
-    _pMixer = MIX_CreateMixerDevice(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, NULL);
-    if (!_pMixer) { throw std::runtime_error(SDL_GetError()); }
+    for (std::atomic<float>& gain : _priorityGain) {
+        gain = 1.f;
+    }
+
+    _sink = AudioSink::create(sink);
+    _pMixer = _sink->getMixer();
 
-    _pMainTrack = MIX_CreateTrack(_pMixer);
-    if (!_pMainTrack) { throw std::runtime_error(SDL_GetError()); }
+    for (Voice& voice : _voices) {
+        voice.track = MIX_CreateTrack(_pMixer);
+        if (!voice.track) { throw std::runtime_error(SDL_GetError()); }
 
-    MIX_SetTrackStoppedCallback(_pMainTrack, trackStoppedCallback, this);
+        MIX_SetTrackStoppedCallback(voice.track, trackStoppedCallback, this);
+    }
+
+    _wakeup = SDL_CreateSemaphore(0);
+    if (!_wakeup) { throw std::runtime_error(SDL_GetError()); }
+
+    _eventThread = std::thread(&AudioPlayer::schedulerThread, this);
+    _sink->start();
 }
 
 
 AudioPlayer::~AudioPlayer()
 {
-    MIX_DestroyTrack(_pMainTrack);
-    MIX_DestroyMixer(_pMixer);
+    _stopThread = true;
+    SDL_SignalSemaphore(_wakeup);
+
+    if (_eventThread.joinable()) {
+        _eventThread.join();
+    }
+
+    // Stops rendering before the tracks go away
+    _sink->stop();
+
+    // Pending decodes use the mixer and signal the scheduler
+    _decodePool.stop();
+
+    SDL_DestroySemaphore(_wakeup);
+
+    for (Voice& voice : _voices) {
+        MIX_DestroyTrack(voice.track);
+    }
+
+    for (const Clip& clip : _clips) {
+        if (clip.audio) {
+            MIX_DestroyAudio(clip.audio);
+        }
+    }
+
+    _sink.reset();
     MIX_Quit();
 }
 
 
-void AudioPlayer::addTrack(const std::filesystem::path& path)
+AudioClipId AudioPlayer::loadClip(const std::filesystem::path& path)
 {
-    // TODO: optimization - this is not ideal, the decoding shall be done 
-    //       the at voicepack level once instead of decoding again and 
-    //       again the same track.
-    MIX_Audio* nextVoiceline = MIX_LoadAudio(_pMixer, path.string().c_str(), true);
+    const std::string key = path.string();
+
+    std::lock_guard<std::mutex> lock(_clipMutex);
+    auto it = _clipIds.find(key);
+
+    if (it != _clipIds.end()) {
+        return it->second;
+    }
+
+    // Decoded on first use or prefetch
+    Clip clip;
+    clip.path = key;
+    clip.lruIt = _lru.end();
+
+    _clips.push_back(clip);
+    const AudioClipId clipId = (AudioClipId)_clips.size();
+    _clipIds[key] = clipId;
+
+    return clipId;
+}
+
+
+AudioClipId AudioPlayer::loadRawClip(const std::string& key, const void* pcm, size_t bytes, uint32_t format, uint32_t channels, uint32_t freq)
+{
+    std::lock_guard<std::mutex> lock(_clipMutex);
+    auto it = _clipIds.find(key);
+
+    if (it != _clipIds.end()) {
+        return it->second;
+    }
+
+    SDL_AudioSpec spec;
+    spec.format = (SDL_AudioFormat)format;
+    spec.channels = (int)channels;
+    spec.freq = (int)freq;
+
+    MIX_Audio* audio = MIX_LoadRawAudioNoCopy(_pMixer, pcm, bytes, &spec, false);
+
+    if (!audio) {
+        std::cerr << "[ERROR ] Could not load raw track: " << key << " " << SDL_GetError() << std::endl;
+        return INVALID_AUDIO_CLIP;
+    }
+
+    Clip clip;
+    clip.path = key;
+    clip.audio = audio;
+    clip.state = ClipReady;
+    clip.mapped = true;
+    clip.lruIt = _lru.end();
+
+    _clips.push_back(clip);
+    const AudioClipId clipId = (AudioClipId)_clips.size();
+    _clipIds[key] = clipId;
+
+    return clipId;
+}
+
+
+void AudioPlayer::pinClip(AudioClipId clip)
+{
+    std::lock_guard<std::mutex> lock(_clipMutex);
+
+    if (clip != INVALID_AUDIO_CLIP && clip <= _clips.size()) {
+        _clips[clip - 1].pinned++;
+    }
+}
+
+
+void AudioPlayer::unpinClip(AudioClipId clip)
+{
+    std::lock_guard<std::mutex> lock(_clipMutex);
+
+    if (clip != INVALID_AUDIO_CLIP && clip <= _clips.size() && _clips[clip - 1].pinned > 0) {
+        // The cache may be over budget with pinned clips only
+        if (--_clips[clip - 1].pinned == 0) {
+            evictClips();
+        }
+    }
+}
+
 
-    if (!nextVoiceline) {
+void AudioPlayer::prefetchClip(AudioClipId clip)
+{
+    {
+        std::lock_guard<std::mutex> lock(_clipMutex);
+
+        if (clip == INVALID_AUDIO_CLIP || clip > _clips.size() || _clips[clip - 1].state != ClipUnloaded) {
+            return;
+        }
+
+        if (!_loadProgress.isLoading()) {
+            _loadProgress = AudioLoadProgress();
+            _loadStart = std::chrono::steady_clock::now();
+        }
+
+        _loadProgress.total++;
+    }
+
+    _decodePool.submit([this, clip]() {
+        std::unique_lock<std::mutex> lock(_clipMutex);
+        const Clip& entry = _clips[clip - 1];
+
+        // Prefetching only fills free space, it never evicts
+        if (entry.state == ClipUnloaded && (entry.pinned || _cacheBytes < _cacheBudget)) {
+            _cacheStats.prefetches++;
+            decodeClip(lock, clip);
+        }
+
+        _loadProgress.done++;
+
+        if (!_loadProgress.isLoading()) {
+            const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _loadStart).count();
+            std::cout << "[INFO  ] Prefetched " << _loadProgress.total << " clips in " << elapsedMs << " ms on "
+                      << _decodePool.getThreadCount() << " threads, cache uses " << (_cacheBytes >> 20) << " MB" << std::endl;
+        }
+    });
+}
+
+
+bool AudioPlayer::decodeClip(std::unique_lock<std::mutex>& lock, AudioClipId clip)
+{
+    // Another thread is decoding it
+    if (_clips[clip - 1].state == ClipLoading) {
+        _clipDecoded.wait(lock, [this, clip]() { return _clips[clip - 1].state != ClipLoading; });
+        return _clips[clip - 1].state == ClipReady;
+    }
+
+    if (_clips[clip - 1].state != ClipUnloaded) {
+        return _clips[clip - 1].state == ClipReady;
+    }
+
+    _clips[clip - 1].state = ClipLoading;
+
+    return loadClipAudio(lock, clip);
+}
+
+
+bool AudioPlayer::loadClipAudio(std::unique_lock<std::mutex>& lock, AudioClipId clip)
+{
+    const std::string path = _clips[clip - 1].path;
+
+    // Decoded outside the lock, playback is not delayed by a load
+    lock.unlock();
+    MIX_Audio* audio = MIX_LoadAudio(_pMixer, path.c_str(), true);
+    lock.lock();
+
+    // _clips may have grown meanwhile
+    Clip& entry = _clips[clip - 1];
+
+    if (!audio) {
         std::cerr << "[ERROR ] Could not load track: " << path << " " << SDL_GetError() << std::endl;
+        entry.state = ClipFailed;
+    }
+    else {
+        entry.audio = audio;
+        entry.bytes = getAudioBytes(audio);
+        entry.state = ClipReady;
+
+        _cacheBytes += entry.bytes;
+        touchClip(clip);
+        evictClips();
+    }
+
+    _clipDecoded.notify_all();
+
+    // Lines wait for it in the scheduler
+    if (entry.queued > 0) {
+        SDL_SignalSemaphore(_wakeup);
+    }
+
+    return entry.state == ClipReady;
+}
+
+
+AudioPlayer::ClipState AudioPlayer::getClipState(AudioClipId clip) const
+{
+    std::lock_guard<std::mutex> lock(_clipMutex);
+
+    return _clips[clip - 1].state;
+}
+
+
+void AudioPlayer::touchClip(AudioClipId clip)
+{
+    Clip& entry = _clips[clip - 1];
+
+    if (entry.mapped) {
         return;
     }
 
-    _trackQueue.push(nextVoiceline);
+    if (entry.lruIt != _lru.end()) {
+        _lru.erase(entry.lruIt);
+    }
+
+    _lru.push_front(clip);
+    entry.lruIt = _lru.begin();
+}
+
+
+void AudioPlayer::evictClips()
+{
+    // Least recently used first, pinned and queued clips are kept, as is the
+    // most recent one which is about to be played
+    auto it = _lru.end();
+
+    while (_cacheBytes > _cacheBudget && _lru.size() > 1 && it != std::next(_lru.begin())) {
+        --it;
+        Clip& entry = _clips[*it - 1];
+
+        if (entry.pinned || entry.queued > 0) {
+            continue;
+        }
+
+        MIX_DestroyAudio(entry.audio);
+        entry.audio = nullptr;
+        entry.state = ClipUnloaded;
+
+        _cacheBytes -= entry.bytes;
+        entry.bytes = 0;
+        _cacheStats.evictions++;
+
+        entry.lruIt = _lru.end();
+        it = _lru.erase(it);
+    }
+}
+
+
+size_t AudioPlayer::getAudioBytes(MIX_Audio* audio)
+{
+    SDL_AudioSpec spec;
+
+    if (!MIX_GetAudioFormat(audio, &spec)) {
+        return 0;
+    }
+
+    const Sint64 frames = MIX_GetAudioDuration(audio);
+
+    return (frames > 0) ? (size_t)frames * spec.channels * SDL_AUDIO_BYTESIZE(spec.format) : 0;
+}
 
-    // No track are currently playing, we'll start on our own the player
-    if (_trackQueue.size() == 1) {
-        MIX_Audio* nextAudio = _trackQueue.front();
-        MIX_SetTrackAudio(_pMainTrack, nextAudio);
 
-        if (!MIX_PlayTrack(_pMainTrack, 0)) {
-            std::cerr << "[ERROR ] Could not start track " << SDL_GetError() << std::endl;
-            MIX_DestroyAudio(_trackQueue.front());
-            _trackQueue.pop();
+void AudioPlayer::setCacheBudget(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(_clipMutex);
+
+    _cacheBudget = bytes;
+    evictClips();
+}
+
+
+AudioCacheStats AudioPlayer::getCacheStats() const
+{
+    std::lock_guard<std::mutex> lock(_clipMutex);
+
+    AudioCacheStats stats = _cacheStats;
+    stats.bytes = _cacheBytes;
+    stats.budget = _cacheBudget;
+
+    for (const Clip& clip : _clips) {
+        if (clip.state == ClipReady) {
+            stats.clips++;
+        }
+        if (clip.pinned && clip.state == ClipReady) {
+            stats.pinnedBytes += clip.bytes;
         }
     }
+
+    return stats;
+}
+
+
+bool AudioPlayer::isClipReady(AudioClipId clip) const
+{
+    std::lock_guard<std::mutex> lock(_clipMutex);
+
+    return clip != INVALID_AUDIO_CLIP && clip <= _clips.size() && _clips[clip - 1].state == ClipReady;
+}
+
+
+AudioLoadProgress AudioPlayer::getLoadProgress() const
+{
+    std::lock_guard<std::mutex> lock(_clipMutex);
+
+    return _loadProgress;
+}
+
+
+void AudioPlayer::addTrack(const VoiceRequest& request)
+{
+    const AudioClipId clip = request.clip;
+    bool decode = false;
+
+    {
+        std::lock_guard<std::mutex> lock(_clipMutex);
+
+        if (clip == INVALID_AUDIO_CLIP || clip > _clips.size()) {
+            return;
+        }
+
+        Clip& entry = _clips[clip - 1];
+
+        if (entry.state == ClipFailed) {
+            return;
+        }
+
+        if (entry.state == ClipReady) {
+            _cacheStats.hits++;
+            touchClip(clip);
+        }
+        else {
+            // Never decoded on the caller thread, the scheduler holds the
+            // line until the pool is done
+            _cacheStats.misses++;
+
+            if (entry.state == ClipUnloaded) {
+                entry.state = ClipLoading;
+                decode = true;
+            }
+        }
+
+        // Not evicted while waiting or playing
+        entry.queued++;
+    }
+
+    if (decode) {
+        _decodePool.submit([this, clip]() {
+            std::unique_lock<std::mutex> lock(_clipMutex);
+            loadClipAudio(lock, clip);
+        });
+    }
+
+    if (!pushRequest(request)) {
+        releaseClip(clip);
+        return;
+    }
+
+    SDL_SignalSemaphore(_wakeup);
+}
+
+
+void AudioPlayer::schedulerThread()
+{
+    // Sole owner of the scheduler and the voices. The mixer is never called
+    // with _trackMutex held, which only guards the statistics.
+    //
+    // One speech line plays at a time, in priority order. A critical line
+    // starts over a lower one on a free track and ducks it until it ends.
+    // Overlays start at once on any free track.
+    while (true) {
+        SDL_WaitSemaphore(_wakeup);
+
+        if (_stopThread) {
+            break;
+        }
+
+        std::vector<VoiceRequest> discarded;
+        std::vector<size_t> started;
+        std::vector<size_t> stopping;
+        std::vector<size_t> cleared;
+        std::array<float, VOICE_TRACK_COUNT> gains;
+
+        {
+            std::lock_guard<std::mutex> lock(_trackMutex);
+
+            for (size_t i = 0; i < _voices.size(); i++) {
+                Voice& voice = _voices[i];
+
+                if (voice.finished.exchange(false, std::memory_order_acquire) && voice.active) {
+                    discarded.push_back(voice.request);
+                    voice.active = false;
+                    voice.stopping = false;
+                    cleared.push_back(i);
+                }
+            }
+
+            std::vector<VoiceRequest> overlays;
+            drainRequests(discarded, &overlays);
+
+            for (const VoiceRequest& overlay : overlays) {
+                const std::optional<size_t> free = findFreeVoice();
+
+                if (!free) {
+                    _scheduler.recordDropped(overlay.priority);
+                    discarded.push_back(overlay);
+                    continue;
+                }
+
+                _voices[*free].request = overlay;
+                _voices[*free].active = true;
+                _scheduler.recordImmediate(overlay.priority);
+                started.push_back(*free);
+            }
+
+            while (!_scheduler.empty()) {
+                const std::optional<VoicePriority> speech = getSpeechPriority();
+
+                // A critical line does not wait for a lower one to finish
+                if (speech && !(_scheduler.topPriority() == Critical && *speech < Critical)) {
+                    break;
+                }
+
+                const std::optional<size_t> free = findFreeVoice();
+
+                if (!free) {
+                    // Every track is busy: fade out the lowest line, the
+                    // stopped callback wakes us up again
+                    std::optional<size_t> lowest;
+
+                    for (size_t i = 0; i < _voices.size(); i++) {
+                        const Voice& voice = _voices[i];
+
+                        if (voice.active && !voice.stopping && voice.request.priority < Critical &&
+                            (!lowest || voice.request.priority < _voices[*lowest].request.priority)) {
+                            lowest = i;
+                        }
+                    }
+
+                    if (lowest) {
+                        _voices[*lowest].stopping = true;
+                        _scheduler.recordPreempted(_voices[*lowest].request.priority);
+                        stopping.push_back(*lowest);
+                    }
+
+                    break;
+                }
+
+                const std::optional<VoiceRequest> next = _scheduler.pop(std::chrono::steady_clock::now(), discarded);
+
+                if (!next) {
+                    break;
+                }
+
+                _voices[*free].request = *next;
+                _voices[*free].active = true;
+                started.push_back(*free);
+            }
+
+            bool ducked = false;
+
+            for (const Voice& voice : _voices) {
+                ducked |= voice.active && !voice.request.overlay && voice.request.priority == Critical;
+            }
+
+            for (size_t i = 0; i < _voices.size(); i++) {
+                gains[i] = getVoiceGain(_voices[i], ducked);
+            }
+        }
+
+        for (size_t i : stopping) {
+            MIX_StopTrack(_voices[i].track, MIX_TrackMSToFrames(_voices[i].track, VOICE_PREEMPT_FADE_MS));
+        }
+
+        // No MIX_DestroyAudio, the audio is owned by the clip cache
+        for (size_t i : cleared) {
+            if (std::find(started.begin(), started.end(), i) == started.end()) {
+                MIX_SetTrackAudio(_voices[i].track, NULL);
+            }
+        }
+
+        for (const VoiceRequest& line : discarded) {
+            releaseClip(line.clip);
+        }
+
+        // Gain changes are applied on the next wake up as well
+        for (size_t i = 0; i < _voices.size(); i++) {
+            MIX_SetTrackGain(_voices[i].track, gains[i]);
+        }
+
+        for (size_t i : started) {
+            const VoiceRequest& request = _voices[i].request;
+
+            std::string clipPath;
+            {
+                std::lock_guard<std::mutex> lock(_clipMutex);
+                clipPath = _clips[request.clip - 1].path;
+            }
+
+            {
+                std::unique_lock<std::mutex> timeline = _sink->lockTimeline();
+
+                if (!playClip(_voices[i].track, request.clip)) {
+                    _voices[i].finished = true;
+                    SDL_SignalSemaphore(_wakeup);
+                    continue;
+                }
+
+                _sink->onVoiceStarted(_latency.getEventTypeName(request.trace.eventType), clipPath);
+            }
+
+            LatencyTrace trace = request.trace;
+            trace.stamp(Started);
+            _latency.record(trace);
+        }
+    }
+}
+
+
+std::optional<size_t> AudioPlayer::findFreeVoice() const
+{
+    for (size_t i = 0; i < _voices.size(); i++) {
+        if (!_voices[i].active) {
+            return i;
+        }
+    }
+
+    return std::nullopt;
+}
+
+
+std::optional<VoicePriority> AudioPlayer::getSpeechPriority() const
+{
+    std::optional<VoicePriority> priority;
+
+    for (const Voice& voice : _voices) {
+        if (voice.active && !voice.request.overlay && (!priority || voice.request.priority > *priority)) {
+            priority = voice.request.priority;
+        }
+    }
+
+    return priority;
+}
+
+
+float AudioPlayer::getVoiceGain(const Voice& voice, bool ducked) const
+{
+    if (!voice.active) {
+        return 1.f;
+    }
+
+    float gain = voice.request.overlay ? _overlayGain.load() : _priorityGain[voice.request.priority].load();
+
+    if (ducked && (voice.request.overlay || voice.request.priority < Critical)) {
+        gain *= _duckingGain;
+    }
+
+    return gain;
+}
+
+
+bool AudioPlayer::playClip(MIX_Track* track, AudioClipId clip)
+{
+    MIX_Audio* audio;
+
+    {
+        std::lock_guard<std::mutex> lock(_clipMutex);
+        audio = _clips[clip - 1].audio;
+    }
+
+    MIX_SetTrackAudio(track, audio);
+
+    if (!MIX_PlayTrack(track, 0)) {
+        std::cerr << "[ERROR ] Could not start track " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+void AudioPlayer::releaseClip(AudioClipId clip)
+{
+    std::lock_guard<std::mutex> lock(_clipMutex);
+    _clips[clip - 1].queued--;
 }
 
 
 float AudioPlayer::getVolume() const
 {
-    return MIX_GetTrackGain(_pMainTrack);
+    return MIX_GetMasterGain(_pMixer);
 }
 
 
 void AudioPlayer::setVolume(float volume)
 {
-    MIX_SetTrackGain(_pMainTrack, volume);
+    MIX_SetMasterGain(_pMixer, volume);
 }
 
 
-void AudioPlayer::trackStoppedCallback(void* userdata, MIX_Track *track)
+void AudioPlayer::setPriorityGain(VoicePriority priority, float gain)
 {
-    AudioPlayer* obj = (AudioPlayer*)userdata;
+    _priorityGain[priority] = gain;
+    SDL_SignalSemaphore(_wakeup);
+}
+
+
+void AudioPlayer::setOverlayGain(float gain)
+{
+    _overlayGain = gain;
+    SDL_SignalSemaphore(_wakeup);
+}
+
+
+void AudioPlayer::setDuckingGain(float gain)
+{
+    _duckingGain = gain;
+    SDL_SignalSemaphore(_wakeup);
+}
 
-    // Pop the current track, no MIX_DestroyAudio, it is handled by the MIX_Track
-    obj->_trackQueue.pop();
-    MIX_SetTrackAudio(obj->_pMainTrack, NULL);
 
-    // Check if queue has additional tracks to play else do nothing,
-    // addTrack will handle the next track by itself
-    if (obj->_trackQueue.size() > 0) {
-        MIX_Audio* nextAudio = obj->_trackQueue.front();
-        MIX_SetTrackAudio(obj->_pMainTrack, nextAudio);
+void AudioPlayer::trackStoppedCallback(void* userdata, MIX_Track *track)
+{
+    AudioPlayer* obj = (AudioPlayer*)userdata;
 
-        if (!MIX_PlayTrack(obj->_pMainTrack, 0)) {
-            std::cerr << "[ERROR ] Could not start track " << SDL_GetError() << std::endl;
-            MIX_DestroyAudio(obj->_trackQueue.front());
-            obj->_trackQueue.pop();
+    // Called from the mixer thread: no lock, the scheduler thread starts the next line
+    for (Voice& voice : obj->_voices) {
+        if (voice.track == track) {
+            voice.finished.store(true, std::memory_order_release);
+            break;
         }
     }
+
+    SDL_SignalSemaphore(obj->_wakeup);
 }
 
 
@@ -136,11 +824,19 @@ STDMETHODIMP_(ULONG) PlayerCallback::Release()
 // AudioPlayer implementation
 // ----------------------------------------------------------------------------
 
-AudioPlayer::AudioPlayer()
+AudioPlayer::AudioPlayer(const AudioSinkConfig& sink)
     : _eventThread(&AudioPlayer::messageLoop, this)
 {
     HRESULT hr;
 
+    if (sink.type != AudioSinkDevice) {
+        std::cerr << "[ERROR ] Media Foundation only plays on the audio device" << std::endl;
+    }
+
+    for (std::atomic<float>& gain : _priorityGain) {
+        gain = 1.f;
+    }
+
     hr = MFStartup(MF_VERSION);
 
     if (FAILED(hr)) {
@@ -181,17 +877,88 @@ AudioPlayer::~AudioPlayer()
 }
 
 
-void AudioPlayer::addTrack(const std::filesystem::path& path)
+AudioClipId AudioPlayer::loadClip(const std::filesystem::path& path)
 {
-    // Avoid queue twice the same track or overflow the queue
-    if (_trackQueue.has(path) || _trackQueue.size() > 4) {
-        return;
+    if (!std::filesystem::exists(path)) {
+        std::cerr << "[ERROR ] Could not load track: " << path << std::endl;
+        return INVALID_AUDIO_CLIP;
     }
 
-    _trackQueue.push(path);
+    const std::string key = path.string();
+
+    std::lock_guard<std::mutex> lock(_clipMutex);
+    auto it = _clipIds.find(key);
+
+    if (it != _clipIds.end()) {
+        return it->second;
+    }
+
+    _clips.push_back(path);
+    const AudioClipId clip = (AudioClipId)_clips.size();
+    _clipIds[key] = clip;
+
+    return clip;
+}
+
+
+bool AudioPlayer::isClipReady(AudioClipId clip) const
+{
+    std::lock_guard<std::mutex> lock(_clipMutex);
+
+    return clip != INVALID_AUDIO_CLIP && clip <= _clips.size();
+}
+
+
+AudioLoadProgress AudioPlayer::getLoadProgress() const
+{
+    // Nothing decoded ahead of time
+    return AudioLoadProgress();
+}
+
+
+AudioClipId AudioPlayer::loadRawClip(const std::string& key, const void* pcm, size_t bytes, uint32_t format, uint32_t channels, uint32_t freq)
+{
+    std::cerr << "[ERROR ] Raw PCM clips are not supported by Media Foundation: " << key << std::endl;
+    return INVALID_AUDIO_CLIP;
+}
+
+
+void AudioPlayer::pinClip(AudioClipId clip)
+{
+}
+
+
+void AudioPlayer::unpinClip(AudioClipId clip)
+{
+}
+
+
+void AudioPlayer::prefetchClip(AudioClipId clip)
+{
+}
+
+
+void AudioPlayer::setCacheBudget(size_t bytes)
+{
+}
+
+
+AudioCacheStats AudioPlayer::getCacheStats() const
+{
+    return AudioCacheStats();
+}
+
 
-    // Signal the thread to check for new tracks
-    PostThreadMessage(GetThreadId(_eventThread.native_handle()), WM_USER + 1, 0, 0);
+void AudioPlayer::addTrack(const VoiceRequest& request)
+{
+    if (request.clip == INVALID_AUDIO_CLIP) {
+        return;
+    }
+
+    if (pushRequest(request)) {
+        // Signal the thread to check for new tracks
+        PostThreadMessage(GetThreadId(_eventThread.native_handle()), WM_USER + 1, 0, 0);
+    }
 }
 
 
@@ -204,7 +971,26 @@ float AudioPlayer::getVolume() const
 void AudioPlayer::setVolume(float volume)
 {
     _volume = volume;
-    _pPlayer->SetVolume(_volume);
+    _pPlayer->SetVolume(_volume * _priorityGain[_current.priority]);
+}
+
+
+void AudioPlayer::setPriorityGain(VoicePriority priority, float gain)
+{
+    _priorityGain[priority] = gain;
+}
+
+
+void AudioPlayer::setOverlayGain(float gain)
+{
+    _overlayGain = gain;
+}
+
+
+void AudioPlayer::setDuckingGain(float gain)
+{
+    // Single voice, nothing plays under a critical line
+    _duckingGain = gain;
 }
 
 
@@ -218,19 +1004,79 @@ void AudioPlayer::messageLoop()
         DispatchMessage(&msg);
 
         if (msg.message == WM_USER + 1) {
+            std::optional<VoiceRequest> next;
+            std::vector<VoiceRequest> discarded;
+            bool preempt = false;
+
+            {
+                std::lock_guard<std::mutex> lock(_trackMutex);
+
+                // Overlays are queued like the other lines, there is a single voice.
+                // A critical line does not wait for a lower one to finish.
+                if (drainRequests(discarded, nullptr) && !_playerCallback->finished && _current.priority < Critical) {
+                    _scheduler.recordPreempted(_current.priority);
+                    preempt = true;
+                }
+            }
+
+            if (preempt) {
+                // Preempted by a critical line: fade out, then go to next track
+                const int steps = 10;
+
+                for (int i = steps - 1; i >= 0; i--) {
+                    _pPlayer->SetVolume(_volume * (float)i / (float)steps);
+                    Sleep(VOICE_PREEMPT_FADE_MS / steps);
+                }
+
+                _pPlayer->Stop();
+                _playerCallback->finished = true;
+            }
+
             // Go to next track
-            if (!_trackQueue.empty() && _playerCallback->finished) {
-                const std::wstring track = _trackQueue.front();
-                _trackQueue.pop();
+            if (_playerCallback->finished) {
+                {
+                    std::lock_guard<std::mutex> lock(_trackMutex);
+                    next = _scheduler.pop(std::chrono::steady_clock::now(), discarded);
+
+                    if (next) {
+                        _current = *next;
+                    }
+                }
+
+                if (!next) {
+                    continue;
+                }
+
+                std::wstring track;
+                {
+                    std::lock_guard<std::mutex> lock(_clipMutex);
+
+                    if (next->clip > _clips.size()) {
+                        continue;
+                    }
+
+                    track = _clips[next->clip - 1].wstring();
+                }
 
                 IMFPMediaItem* pMediaItem = nullptr;
                 hr = _pPlayer->CreateMediaItemFromURL(track.c_str(), TRUE, NULL, &pMediaItem);
 
                 if (SUCCEEDED(hr) && pMediaItem) {
+                    const float gain = next->overlay ? _overlayGain.load() : _priorityGain[next->priority].load();
+
                     _playerCallback->finished = false;
+                    _pPlayer->SetVolume(_volume * gain);
                     _pPlayer->SetMediaItem(pMediaItem);
                     _pPlayer->Play();
                     pMediaItem->Release();
+
+                    // Play is asynchronous, the first sample comes slightly later
+                    next->trace.stamp(Started);
+                    _latency.record(next->trace);
+                }
+                else {
+                    // Try the next one
+                    PostThreadMessage(GetThreadId(_eventThread.native_handle()), WM_USER + 1, 0, 0);
                 }
             }
         }
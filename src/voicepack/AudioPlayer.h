@@ -1,12 +1,26 @@
 #pragma once
 
 #include <iostream>
+#include <array>
 #include <filesystem>
+#include <list>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <config.h>
-#include "AtomicQueue.hpp"
+#include "AudioClip.h"
+#include "AudioSink.h"
+#include "VoiceScheduler.h"
+#include "../util/LatencyTrace.h"
+#include "../util/MpscRing.hpp"
+#include "../util/ThreadPool.h"
 
 #ifdef USE_SDL_MIXER
     #include <SDL3_mixer/SDL_mixer.h>
@@ -43,18 +57,84 @@
 #endif // USE_SDL_MIXER
 
 
+// Decoding progress of the clips requested since the player was last idle
+struct AudioLoadProgress {
+    size_t done = 0;
+    size_t total = 0;
+
+    bool isLoading() const { return done < total; }
+};
+
+
+// PCM cache usage, decoded clips are kept until the budget is exceeded
+struct AudioCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t prefetches = 0;
+    size_t clips = 0;
+    size_t bytes = 0;
+    size_t pinnedBytes = 0;
+    size_t budget = 0;
+};
+
+
 class AudioPlayer
 {
 public:
-    AudioPlayer();
+    explicit AudioPlayer(const AudioSinkConfig& sink = AudioSinkConfig());
 
     ~AudioPlayer();
 
-    void addTrack(const std::filesystem::path& path);
+    // Registers the file, the same path always gives the same clip.
+    // Decoding happens on first play or on prefetch.
+    AudioClipId loadClip(const std::filesystem::path& path);
+
+    // Uncompressed interleaved PCM owned by the caller, which must keep it
+    // alive as long as the player. Never decoded nor evicted.
+    AudioClipId loadRawClip(const std::string& key, const void* pcm, size_t bytes, uint32_t format, uint32_t channels, uint32_t freq);
+
+    // Pinned clips are never evicted from the cache. Pins are counted,
+    // each pinClip is matched by an unpinClip.
+    void pinClip(AudioClipId clip);
+    void unpinClip(AudioClipId clip);
+
+    // Decodes the clip in the background if the cache has room for it
+    void prefetchClip(AudioClipId clip);
+
+    bool isClipReady(AudioClipId clip) const;
+
+    AudioLoadProgress getLoadProgress() const;
+
+    void setCacheBudget(size_t bytes);
+    AudioCacheStats getCacheStats() const;
+
+    // Queued by priority. With SDL a critical line plays over the others,
+    // which are ducked, and overlays start at once. Media Foundation has a
+    // single voice: a critical line interrupts the current one.
+    // A clip not in the cache is decoded on the pool, its line waits for it.
+    void addTrack(const VoiceRequest& request);
+
+    VoiceSchedulerStats getSchedulerStats() const;
+
+    // Traces of the requests are recorded when their playback starts
+    LatencyRecorder& getLatencyRecorder() { return _latency; }
+    const LatencyRecorder& getLatencyRecorder() const { return _latency; }
 
     float getVolume() const;
     void setVolume(float volume);
 
+    // Relative gain of each priority, and of overlays
+    float getPriorityGain(VoicePriority priority) const;
+    void setPriorityGain(VoicePriority priority, float gain);
+
+    float getOverlayGain() const;
+    void setOverlayGain(float gain);
+
+    // Gain of the other voices while a critical line plays, SDL only
+    float getDuckingGain() const;
+    void setDuckingGain(float gain);
+
 private:
     std::atomic<bool> _stopThread{ false };
     std::thread _eventThread;
@@ -62,17 +142,118 @@ private:
 #ifdef USE_SDL_MIXER
     static void SDLCALL trackStoppedCallback(void* userdata, MIX_Track *track);
 
+    // Owns the mixer
+    std::unique_ptr<AudioSink> _sink;
     MIX_Mixer* _pMixer;
-    MIX_Track* _pMainTrack;
 
-    AtomicQueue<MIX_Audio*> _trackQueue;
+    // One voice per track of the mixer
+    struct Voice {
+        MIX_Track* track = nullptr;
+        std::atomic<bool> finished{ false };
+
+        // Scheduler thread only
+        VoiceRequest request;
+        bool active = false;
+        bool stopping = false;
+    };
+
+    void schedulerThread();
+
+    // Called with _trackMutex held
+    std::optional<size_t> findFreeVoice() const;
+    std::optional<VoicePriority> getSpeechPriority() const;
+    float getVoiceGain(const Voice& voice, bool ducked) const;
+
+    bool playClip(MIX_Track* track, AudioClipId clip);
+    void releaseClip(AudioClipId clip);
+
+    std::array<Voice, VOICE_TRACK_COUNT> _voices;
+
+    // Wakes the scheduler thread, signaled from any thread without locking
+    SDL_Semaphore* _wakeup = nullptr;
+
+    enum ClipState {
+        ClipUnloaded,
+        ClipLoading,
+        ClipReady,
+        ClipFailed
+    };
+
+    struct Clip {
+        std::string path;
+        MIX_Audio* audio = nullptr;
+        ClipState state = ClipUnloaded;
+        size_t bytes = 0;
+        uint32_t queued = 0;    // Waiting, decoding or playing on the track
+        uint32_t pinned = 0;    // Pin count
+        bool mapped = false;    // Raw PCM of the caller, not in the LRU
+        std::list<AudioClipId>::iterator lruIt;
+    };
+
+    // Called with _clipMutex held, released while decoding
+    bool decodeClip(std::unique_lock<std::mutex>& lock, AudioClipId clip);
+    // Same, the clip is already marked loading by the caller
+    bool loadClipAudio(std::unique_lock<std::mutex>& lock, AudioClipId clip);
+    ClipState getClipState(AudioClipId clip) const;
+    void touchClip(AudioClipId clip);
+    void evictClips();
+
+    static size_t getAudioBytes(MIX_Audio* audio);
+
+    // Indexed by clip id - 1
+    std::vector<Clip> _clips;
+
+    // Most recently used first, decoded clips only
+    std::list<AudioClipId> _lru;
+    std::condition_variable _clipDecoded;
+
+    size_t _cacheBytes = 0;
+    size_t _cacheBudget = 128 << 20;
+    AudioCacheStats _cacheStats;
+
+    std::chrono::steady_clock::time_point _loadStart;
+    ThreadPool _decodePool;
+
+    // Lines held until the pool decodes their clip, scheduler thread only
+    std::vector<VoiceRequest> _decoding;
 #else
     void messageLoop();
 
     IMFPMediaPlayer* _pPlayer = nullptr;
     PlayerCallback* _playerCallback = nullptr;
-    AtomicQueue<std::filesystem::path> _trackQueue;
+    VoiceRequest _current;
+
+    // Media Foundation decodes while streaming: a clip is only its path
+    std::vector<std::filesystem::path> _clips;
 #endif // USE_SDL_MIXER
 
+    // False if the ingress ring is full
+    bool pushRequest(const VoiceRequest& request);
+
+    // Moves the new lines to the scheduler, player thread only. Overlays
+    // are returned apart when given a vector, otherwise they are queued.
+    // Returns true if a critical line was queued.
+    bool drainRequests(std::vector<VoiceRequest>& discarded, std::vector<VoiceRequest>* overlays);
+
+    // New lines, from any thread to the player thread
+    MpscRing<VoiceRequest> _ingress{ 64 };
+    std::atomic<uint64_t> _ingressDropped{ 0 };
+    std::atomic<bool> _ingressOverflowing{ false };
+
+    // Lines waiting, and the ones playing. Owned by the player thread,
+    // _trackMutex lets the statistics be read from other threads.
+    VoiceScheduler _scheduler;
+    mutable std::mutex _trackMutex;
+
+    std::array<std::atomic<float>, N_VoicePriorities> _priorityGain;
+    std::atomic<float> _overlayGain{ 1.f };
+    std::atomic<float> _duckingGain{ DEFAULT_DUCKING_GAIN };
+
+    LatencyRecorder _latency;
+
+    std::unordered_map<std::string, AudioClipId> _clipIds;
+    AudioLoadProgress _loadProgress;
+    mutable std::mutex _clipMutex;
+
     float _volume = 1.f;
 };
\ No newline at end of file
@@ -0,0 +1,271 @@
+#include "AudioSink.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+
+AudioSinkConfig AudioSinkConfig::fromEnvironment()
+{
+    AudioSinkConfig config;
+    const char* value = std::getenv("EDVOICE_AUDIO_SINK");
+
+    if (!value) {
+        return config;
+    }
+
+    const std::string sink = value;
+
+    if (sink == "null") {
+        config.type = AudioSinkNull;
+    }
+    else if (sink.rfind("wav:", 0) == 0 && sink.size() > 4) {
+        config.type = AudioSinkWav;
+        config.wavPath = sink.substr(4);
+    }
+    else if (sink != "device") {
+        std::cerr << "[ERR   ] Unknown audio sink: " << sink << ", using the audio device" << std::endl;
+    }
+
+    return config;
+}
+
+
+#ifdef USE_SDL_MIXER
+
+std::unique_ptr<AudioSink> AudioSink::create(const AudioSinkConfig& config)
+{
+    switch (config.type) {
+    case AudioSinkNull:
+        std::cout << "[INFO  ] Audio rendered without output" << std::endl;
+        return std::make_unique<NullAudioSink>();
+    case AudioSinkWav:
+        std::cout << "[INFO  ] Audio rendered to " << config.wavPath << std::endl;
+        return std::make_unique<WavAudioSink>(config.wavPath);
+    case AudioSinkDevice:
+    default:
+        return std::make_unique<DeviceAudioSink>();
+    }
+}
+
+
+AudioSink::~AudioSink()
+{
+    if (_pMixer) {
+        MIX_DestroyMixer(_pMixer);
+    }
+}
+
+
+// ----------------------------------------------------------------------------
+// DeviceAudioSink
+// ----------------------------------------------------------------------------
+
+DeviceAudioSink::DeviceAudioSink()
+{
+    _pMixer = MIX_CreateMixerDevice(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, NULL);
+    if (!_pMixer) { throw std::runtime_error(SDL_GetError()); }
+}
+
+
+// ----------------------------------------------------------------------------
+// NullAudioSink
+// ----------------------------------------------------------------------------
+
+NullAudioSink::NullAudioSink()
+{
+    const SDL_AudioSpec spec = { SDL_AUDIO_F32, CHANNELS, FREQ };
+
+    _pMixer = MIX_CreateMixer(&spec);
+    if (!_pMixer) { throw std::runtime_error(SDL_GetError()); }
+}
+
+
+NullAudioSink::~NullAudioSink()
+{
+    stop();
+}
+
+
+void NullAudioSink::start()
+{
+    if (_running) {
+        return;
+    }
+
+    _running = true;
+    _thread = std::thread(&NullAudioSink::renderThread, this);
+}
+
+
+void NullAudioSink::stop()
+{
+    _running = false;
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+
+std::unique_lock<std::mutex> NullAudioSink::lockTimeline()
+{
+    return std::unique_lock<std::mutex>(_timelineMutex);
+}
+
+
+void NullAudioSink::onVoiceStarted(const std::string& eventType, const std::string& clip)
+{
+    _pendingCues.push_back({ 0, eventType, clip });
+}
+
+
+void NullAudioSink::renderThread()
+{
+    std::vector<float> block(BLOCK_FRAMES * CHANNELS);
+    std::vector<Cue> cues;
+
+    const auto blockDuration = std::chrono::microseconds(1000000 * BLOCK_FRAMES / FREQ);
+    auto deadline = std::chrono::steady_clock::now();
+
+    while (_running) {
+        int bytes;
+
+        {
+            // No track starts between taking the cues and mixing them
+            std::lock_guard<std::mutex> lock(_timelineMutex);
+            cues.swap(_pendingCues);
+
+            bytes = MIX_Generate(_pMixer, block.data(), (int)(block.size() * sizeof(float)));
+        }
+
+        // Tracks started since the previous block are mixed from its first frame
+        for (Cue& cue : cues) {
+            cue.frame = _framesRendered;
+            writeCue(cue);
+        }
+
+        cues.clear();
+
+        if (bytes < 0) {
+            std::cerr << "[ERROR ] Could not render audio: " << SDL_GetError() << std::endl;
+            break;
+        }
+
+        const size_t frames = (size_t)bytes / (CHANNELS * sizeof(float));
+        writeBlock(block.data(), frames);
+        _framesRendered += frames;
+
+        // Keeps the pace of a device, without catching up after a stall
+        deadline += blockDuration;
+        const auto now = std::chrono::steady_clock::now();
+
+        if (deadline < now) {
+            deadline = now;
+        }
+        else {
+            std::this_thread::sleep_until(deadline);
+        }
+    }
+}
+
+
+// ----------------------------------------------------------------------------
+// WavAudioSink
+// ----------------------------------------------------------------------------
+
+WavAudioSink::WavAudioSink(const std::filesystem::path& path)
+    : _path(path)
+{
+    _wav.open(path, std::ios::binary | std::ios::trunc);
+
+    if (!_wav) {
+        throw std::runtime_error("Cannot create " + path.string());
+    }
+
+    std::filesystem::path cuesPath = path;
+    cuesPath += ".csv";
+
+    _cues.open(cuesPath, std::ios::trunc);
+
+    if (!_cues) {
+        throw std::runtime_error("Cannot create " + cuesPath.string());
+    }
+
+    _cues << "frame,time_ms,event,clip" << std::endl;
+
+    // Sizes are written once rendering stops
+    writeHeader(0);
+}
+
+
+WavAudioSink::~WavAudioSink()
+{
+    stop();
+}
+
+
+void WavAudioSink::stop()
+{
+    NullAudioSink::stop();
+
+    if (_wav.is_open()) {
+        _wav.seekp(0);
+        writeHeader(_dataBytes);
+        _wav.close();
+
+        std::cout << "[INFO  ] Rendered " << (double)getFramesRendered() / FREQ << " s of audio to " << _path << std::endl;
+    }
+
+    if (_cues.is_open()) {
+        _cues.close();
+    }
+}
+
+
+void WavAudioSink::writeHeader(uint64_t dataBytes)
+{
+    auto write16 = [this](uint16_t v) { _wav.write((const char*)&v, sizeof(v)); };
+    auto write32 = [this](uint32_t v) { _wav.write((const char*)&v, sizeof(v)); };
+
+    const uint16_t bitsPerSample = 32;
+    const uint16_t blockAlign = CHANNELS * bitsPerSample / 8;
+
+    // Capped at 4 GB, the limit of the format
+    const uint32_t dataSize = (uint32_t)std::min<uint64_t>(dataBytes, UINT32_MAX - 36);
+
+    _wav.write("RIFF", 4);
+    write32(36 + dataSize);
+    _wav.write("WAVE", 4);
+
+    _wav.write("fmt ", 4);
+    write32(16);
+    write16(3);     // WAVE_FORMAT_IEEE_FLOAT
+    write16(CHANNELS);
+    write32(FREQ);
+    write32(FREQ * blockAlign);
+    write16(blockAlign);
+    write16(bitsPerSample);
+
+    _wav.write("data", 4);
+    write32(dataSize);
+}
+
+
+void WavAudioSink::writeBlock(const float* samples, size_t frames)
+{
+    const size_t bytes = frames * CHANNELS * sizeof(float);
+
+    _wav.write((const char*)samples, bytes);
+    _dataBytes += bytes;
+}
+
+
+void WavAudioSink::writeCue(const Cue& cue)
+{
+    _cues << cue.frame << "," << (double)cue.frame * 1000. / FREQ << "," << cue.eventType << ",\"" << cue.clip << "\"" << std::endl;
+}
+
+#endif // USE_SDL_MIXER
\ No newline at end of file
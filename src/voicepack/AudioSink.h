@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <config.h>
+
+#ifdef USE_SDL_MIXER
+    #include <SDL3_mixer/SDL_mixer.h>
+#endif
+
+
+// Where the mixed voicelines go. Without a device, the timeline is still
+// rendered in real time so that the voicelines end as they would when heard.
+enum AudioSinkType {
+    AudioSinkDevice,    // Default playback device
+    AudioSinkNull,      // Rendered then discarded
+    AudioSinkWav        // Rendered to a WAV file, with the start of each voiceline
+};
+
+
+struct AudioSinkConfig {
+    AudioSinkType type = AudioSinkDevice;
+    std::filesystem::path wavPath;
+
+    // EDVOICE_AUDIO_SINK: "null" or "wav:<path>", the device otherwise
+    static AudioSinkConfig fromEnvironment();
+};
+
+
+#ifdef USE_SDL_MIXER
+// Owns the mixer the player creates its tracks on. Media Foundation only
+// plays on the device.
+class AudioSink
+{
+public:
+    static std::unique_ptr<AudioSink> create(const AudioSinkConfig& config);
+
+    virtual ~AudioSink();
+
+    AudioSink(const AudioSink&) = delete;
+    AudioSink& operator=(const AudioSink&) = delete;
+
+    MIX_Mixer* getMixer() const { return _pMixer; }
+
+    // Rendering runs between start and stop, the tracks must outlive it
+    virtual void start() {}
+    virtual void stop() {}
+
+    // Held by the player thread while it starts a track and reports it
+    // with onVoiceStarted, so that the start frame is exact
+    virtual std::unique_lock<std::mutex> lockTimeline() { return {}; }
+
+    // A voiceline started playing, called with the timeline locked
+    virtual void onVoiceStarted(const std::string& eventType, const std::string& clip) {}
+
+protected:
+    AudioSink() = default;
+
+    MIX_Mixer* _pMixer = nullptr;
+};
+
+
+class DeviceAudioSink : public AudioSink
+{
+public:
+    DeviceAudioSink();
+};
+
+
+// Pulls the mix in fixed blocks on its own thread, paced on the clock
+class NullAudioSink : public AudioSink
+{
+public:
+    NullAudioSink();
+    ~NullAudioSink();
+
+    void start() override;
+    void stop() override;
+
+    std::unique_lock<std::mutex> lockTimeline() override;
+    void onVoiceStarted(const std::string& eventType, const std::string& clip) override;
+
+    uint64_t getFramesRendered() const { return _framesRendered; }
+
+protected:
+    struct Cue {
+        uint64_t frame;
+        std::string eventType;
+        std::string clip;
+    };
+
+    // Render thread
+    virtual void writeBlock(const float* samples, size_t frames) {}
+    virtual void writeCue(const Cue& cue) {}
+
+    static constexpr int FREQ = 48000;
+    static constexpr int CHANNELS = 2;
+
+    // 10 ms
+    static constexpr size_t BLOCK_FRAMES = FREQ / 100;
+
+private:
+    void renderThread();
+
+    std::thread _thread;
+    std::atomic<bool> _running{ false };
+    std::atomic<uint64_t> _framesRendered{ 0 };
+
+    // Voicelines started since the last block: they start on the next one.
+    // Held while rendering a block.
+    std::vector<Cue> _pendingCues;
+    std::mutex _timelineMutex;
+};
+
+
+// 32 bit float WAV, plus a CSV of the frame each voiceline starts at
+class WavAudioSink : public NullAudioSink
+{
+public:
+    explicit WavAudioSink(const std::filesystem::path& path);
+    ~WavAudioSink();
+
+    void stop() override;
+
+protected:
+    void writeBlock(const float* samples, size_t frames) override;
+    void writeCue(const Cue& cue) override;
+
+private:
+    void writeHeader(uint64_t dataBytes);
+
+    std::filesystem::path _path;
+    std::ofstream _wav;
+    std::ofstream _cues;
+    uint64_t _dataBytes = 0;
+};
+#endif // USE_SDL_MIXER
\ No newline at end of file
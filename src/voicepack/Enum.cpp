@@ -1,5 +1,10 @@
 #include "Enum.h"
 
+#include <array>
+
+#include "../util/PerfectHash.hpp"
+#include "../watchers/StatusEvent.h"
+
 // ----------------------------------------------------------------------------
 // Vehicule enum and conversion functions
 // ----------------------------------------------------------------------------
@@ -14,12 +19,18 @@ const char* vehicleToString(Vehicle v)
     }
 }
 
-std::optional<Vehicle> vehiculeFromString(const std::string& s)
+static constexpr std::array<std::string_view, N_Vehicles> VEHICLE_NAMES = {
+#define GEN_NAME(name) #name,
+    ENUM_VEHICULES(GEN_NAME)
+#undef GEN_NAME
+};
+
+static constexpr PerfectHash<Vehicle, N_Vehicles> VEHICLE_LOOKUP(VEHICLE_NAMES);
+static_assert(VEHICLE_LOOKUP.isValid(), "No perfect hash for Vehicle names");
+
+std::optional<Vehicle> vehiculeFromString(std::string_view s)
 {
-#define GEN_IF(name) if (s == #name) return name;
-    ENUM_VEHICULES(GEN_IF)
-#undef GEN_IF
-        return std::nullopt;
+    return VEHICLE_LOOKUP.find(s);
 }
 
 // ----------------------------------------------------------------------------
@@ -36,12 +47,18 @@ const char* srvTypeToString(SRVType v)
     }
 }
 
-std::optional<SRVType> srvTypeFromString(const std::string& s)
+static constexpr std::array<std::string_view, N_SRVTypes> SRV_TYPE_NAMES = {
+#define GEN_NAME(name) #name,
+    ENUM_SRV_TYPES(GEN_NAME)
+#undef GEN_NAME
+};
+
+static constexpr PerfectHash<SRVType, N_SRVTypes> SRV_TYPE_LOOKUP(SRV_TYPE_NAMES);
+static_assert(SRV_TYPE_LOOKUP.isValid(), "No perfect hash for SRVType names");
+
+std::optional<SRVType> srvTypeFromString(std::string_view s)
 {
-#define GEN_IF(name) if (s == #name) return name;
-    ENUM_SRV_TYPES(GEN_IF)
-#undef GEN_IF
-        return std::nullopt;
+    return SRV_TYPE_LOOKUP.find(s);
 }
 
 // ----------------------------------------------------------------------------
@@ -58,24 +75,55 @@ const char* specialEventToString(SpecialEvent v)
     }
 }
 
-std::optional<SpecialEvent> specialEventFromString(const std::string& s)
+static constexpr std::array<std::string_view, N_SpecialEvents> SPECIAL_EVENT_NAMES = {
+#define GEN_NAME(name) #name,
+    ENUM_SPECIAL_EVENTS(GEN_NAME)
+#undef GEN_NAME
+};
+
+static constexpr PerfectHash<SpecialEvent, N_SpecialEvents> SPECIAL_EVENT_LOOKUP(SPECIAL_EVENT_NAMES);
+static_assert(SPECIAL_EVENT_LOOKUP.isValid(), "No perfect hash for SpecialEvent names");
+
+std::optional<SpecialEvent> specialEventFromString(std::string_view s)
+{
+    return SPECIAL_EVENT_LOOKUP.find(s);
+}
+
+// ----------------------------------------------------------------------------
+// VoicePriority enum and conversion functions
+// ----------------------------------------------------------------------------
+
+const char* voicePriorityToString(VoicePriority v)
+{
+    switch (v) {
+#define GEN_CASE(name) case name: return #name;
+        ENUM_VOICE_PRIORITIES(GEN_CASE)
+#undef GEN_CASE
+    default: return "Unknown";
+    }
+}
+
+static constexpr std::array<std::string_view, N_VoicePriorities> VOICE_PRIORITY_NAMES = {
+#define GEN_NAME(name) #name,
+    ENUM_VOICE_PRIORITIES(GEN_NAME)
+#undef GEN_NAME
+};
+
+static constexpr PerfectHash<VoicePriority, N_VoicePriorities> VOICE_PRIORITY_LOOKUP(VOICE_PRIORITY_NAMES);
+static_assert(VOICE_PRIORITY_LOOKUP.isValid(), "No perfect hash for VoicePriority names");
+
+std::optional<VoicePriority> voicePriorityFromString(std::string_view s)
 {
-#define GEN_IF(name) if (s == #name) return name;
-    ENUM_SPECIAL_EVENTS(GEN_IF)
-#undef GEN_IF
-        return std::nullopt;
+    return VOICE_PRIORITY_LOOKUP.find(s);
 }
 
 // ----------------------------------------------------------------------------
 // Status conversion functions
 // ----------------------------------------------------------------------------
 
-std::optional<StatusEvent> statusFromString(const std::string& s)
+std::optional<StatusEvent> statusFromString(std::string_view s)
 {
-#define GEN_IF(name) if (s == #name) return name;
-    STATUS_EVENTS(GEN_IF)
-#undef GEN_IF
-        return std::nullopt;
+    return StatusEventUtil::fromString(s);
 }
 
 const char* statusToString(StatusEvent ev)
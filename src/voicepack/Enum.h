@@ -3,6 +3,7 @@
 #include <PluginInterface.h>
 
 #include <string>
+#include <string_view>
 #include <optional>
 #include <cstdint>
 
@@ -34,6 +35,14 @@ enum VoiceTriggerStatus {
     X(HullIntegrity_Critical)       \
     X(AutoPilot_Liftoff)            \
     X(AutoPilot_Touchdown)          \
+    X(Fuel_Critical)                \
+    X(Oxygen_Critical)              \
+
+#define ENUM_VOICE_PRIORITIES(X)    \
+    X(Low)                          \
+    X(Normal)                       \
+    X(High)                         \
+    X(Critical)                     \
 
 // ----------------------------------------------------------------------------
 // Vehicule enum and conversion functions
@@ -47,7 +56,7 @@ enum Vehicle {
 };
 
 const char* vehicleToString(Vehicle v);
-std::optional<Vehicle> vehiculeFromString(const std::string& s);
+std::optional<Vehicle> vehiculeFromString(std::string_view s);
 
 // ----------------------------------------------------------------------------
 // SRV enum and conversion functions
@@ -66,7 +75,7 @@ const uint32_t SRV_MAX_CARGO[N_SRVTypes] = {
 };
 
 const char* srvTypeToString(SRVType v);
-std::optional<SRVType> srvTypeFromString(const std::string& s);
+std::optional<SRVType> srvTypeFromString(std::string_view s);
 
 // ----------------------------------------------------------------------------
 // SpecialEvent enum and conversion functions
@@ -80,11 +89,26 @@ enum SpecialEvent {
 };
 
 const char* specialEventToString(SpecialEvent v);
-std::optional<SpecialEvent> specialEventFromString(const std::string& s);
+std::optional<SpecialEvent> specialEventFromString(std::string_view s);
+
+// ----------------------------------------------------------------------------
+// VoicePriority enum and conversion functions
+// ----------------------------------------------------------------------------
+
+// Scheduling class of a voiceline, a critical line interrupts lower ones
+enum VoicePriority {
+#define GEN_ENUM(name) name,
+    ENUM_VOICE_PRIORITIES(GEN_ENUM)
+#undef GEN_ENUM
+    N_VoicePriorities
+};
+
+const char* voicePriorityToString(VoicePriority v);
+std::optional<VoicePriority> voicePriorityFromString(std::string_view s);
 
 // ----------------------------------------------------------------------------
 // Status conversion functions
 // ----------------------------------------------------------------------------
 
-std::optional<StatusEvent> statusFromString(const std::string& s);
+std::optional<StatusEvent> statusFromString(std::string_view s);
 const char* statusToString(StatusEvent ev);
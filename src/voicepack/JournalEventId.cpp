@@ -0,0 +1,226 @@
+#include "JournalEventId.h"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <unordered_map>
+
+
+JournalEventIds::JournalEventIds()
+{
+    static const char* KNOWN_EVENTS[N_KnownJournalEvents] = {
+#define GEN_NAME(name) #name,
+        ENUM_JOURNAL_EVENTS(GEN_NAME)
+#undef GEN_NAME
+    };
+
+    std::vector<const std::string*> names;
+
+    for (const char* name : KNOWN_EVENTS) {
+        _names.emplace_back(name);
+        names.push_back(&_names.back());
+    }
+
+    _table = build(names);
+}
+
+
+JournalEventId JournalEventIds::intern(std::string_view name)
+{
+    return internAll({ name })[0];
+}
+
+
+std::vector<JournalEventId> JournalEventIds::internAll(const std::vector<std::string_view>& names)
+{
+    std::lock_guard<std::mutex> lock(_internMutex);
+
+    std::vector<JournalEventId> ids(names.size(), INVALID_JOURNAL_EVENT);
+    std::vector<const std::string*> tableNames = std::atomic_load(&_table)->names;
+    const size_t nPublished = tableNames.size();
+
+    // Names added by this call, not in the published table yet
+    std::unordered_map<std::string_view, JournalEventId> added;
+
+    for (size_t i = 0; i < names.size(); i++) {
+        ids[i] = find(names[i]);
+
+        if (ids[i] != INVALID_JOURNAL_EVENT) {
+            continue;
+        }
+
+        const auto it = added.find(names[i]);
+
+        if (it != added.end()) {
+            ids[i] = it->second;
+            continue;
+        }
+
+        _names.emplace_back(names[i]);
+        tableNames.push_back(&_names.back());
+
+        ids[i] = (JournalEventId)(tableNames.size() - 1);
+        added.emplace(_names.back(), ids[i]);
+    }
+
+    if (tableNames.size() > nPublished) {
+        std::atomic_store(&_table, build(tableNames));
+    }
+
+    return ids;
+}
+
+
+JournalEventId JournalEventIds::find(std::string_view name) const
+{
+    const std::shared_ptr<const Table> table = std::atomic_load(&_table);
+
+    const JournalEventId id = table->slots[table->slotOf(hash(name, table->seed))];
+
+    if (id != INVALID_JOURNAL_EVENT && *table->names[id] == name) {
+        return id;
+    }
+
+    return INVALID_JOURNAL_EVENT;
+}
+
+
+const std::string& JournalEventIds::getName(JournalEventId id) const
+{
+    const std::shared_ptr<const Table> table = std::atomic_load(&_table);
+
+    if (id >= table->names.size()) {
+        throw std::out_of_range("Invalid journal event id: " + std::to_string(id));
+    }
+
+    return *table->names[id];
+}
+
+
+size_t JournalEventIds::size() const
+{
+    return std::atomic_load(&_table)->names.size();
+}
+
+
+size_t JournalEventIds::Table::slotOf(uint64_t h) const
+{
+    // Mixed with the displacement of the bucket, slots on the high bits
+    uint64_t x = h + displacements[h & bucketMask] * 0x9e3779b97f4a7c15ull;
+
+    x ^= x >> 31;
+    x *= 0xd6e8feb86659fd93ull;
+    x ^= x >> 32;
+
+    return (size_t)(x >> slotShift);
+}
+
+
+uint64_t JournalEventIds::hash(std::string_view name, uint64_t seed)
+{
+    // FNV-1a
+    uint64_t h = 14695981039346656037ull ^ seed;
+
+    for (char c : name) {
+        h ^= (uint8_t)c;
+        h *= 1099511628211ull;
+    }
+
+    return h;
+}
+
+
+bool JournalEventIds::place(Table& table, const std::vector<uint64_t>& hashes)
+{
+    std::vector<std::vector<JournalEventId>> buckets(table.displacements.size());
+
+    for (JournalEventId id = 0; id < hashes.size(); id++) {
+        buckets[hashes[id] & table.bucketMask].push_back(id);
+    }
+
+    // Largest buckets first, while most slots are free
+    std::vector<size_t> order(buckets.size());
+
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&buckets](size_t a, size_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    std::vector<size_t> placed;
+
+    for (size_t iBucket : order) {
+        const std::vector<JournalEventId>& bucket = buckets[iBucket];
+
+        if (bucket.empty()) {
+            break;
+        }
+
+        bool found = false;
+
+        for (uint32_t displacement = 0; displacement < MAX_DISPLACEMENT && !found; displacement++) {
+            table.displacements[iBucket] = displacement;
+            found = true;
+            placed.clear();
+
+            for (JournalEventId id : bucket) {
+                const size_t slot = table.slotOf(hashes[id]);
+
+                if (table.slots[slot] != INVALID_JOURNAL_EVENT) {
+                    found = false;
+                    break;
+                }
+
+                table.slots[slot] = id;
+                placed.push_back(slot);
+            }
+
+            if (!found) {
+                for (size_t slot : placed) {
+                    table.slots[slot] = INVALID_JOURNAL_EVENT;
+                }
+            }
+        }
+
+        if (!found) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+std::shared_ptr<const JournalEventIds::Table> JournalEventIds::build(const std::vector<const std::string*>& names)
+{
+    // Twice as many slots as names, about two names per bucket
+    uint32_t slotBits = 1;
+
+    while (((size_t)1 << slotBits) < 2 * names.size()) {
+        slotBits++;
+    }
+
+    std::shared_ptr<Table> table = std::make_shared<Table>();
+    table->names = names;
+    table->slotShift = 64 - slotBits;
+    table->bucketMask = ((uint64_t)1 << (slotBits > 2 ? slotBits - 2 : 0)) - 1;
+
+    std::vector<uint64_t> hashes(names.size());
+
+    // Another seed only if two names share a bucket and all their slots
+    for (uint64_t seed = 0;; seed++) {
+        table->seed = seed * 0x9e3779b97f4a7c15ull;
+        table->displacements.assign(table->bucketMask + 1, 0);
+        table->slots.assign((size_t)1 << slotBits, INVALID_JOURNAL_EVENT);
+
+        for (size_t i = 0; i < names.size(); i++) {
+            hashes[i] = hash(*names[i], table->seed);
+        }
+
+        if (place(*table, hashes)) {
+            return table;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+// Journal events the voicepacks react to, whether they have a voiceline or not
+#define ENUM_JOURNAL_EVENTS(X)      \
+    X(Shutdown)                     \
+    X(LoadGame)                     \
+    X(UnderAttack)                  \
+    X(LaunchDrone)                  \
+    X(EjectCargo)                   \
+    X(Cargo)                        \
+    X(Loadout)                      \
+    X(CollectCargo)                 \
+    X(Disembark)                    \
+    X(Embark)                       \
+    X(LaunchSRV)                    \
+    X(DockSRV)                      \
+    X(FuelScoop)                    \
+    X(ReservoirReplenished)         \
+    X(HullDamage)                   \
+    X(Liftoff)                      \
+    X(Touchdown)                    \
+
+// Dense id of a journal event name, usable as an index in flat tables.
+// Known events come first, then the names of the voicepacks and of the
+// config in the order they are interned.
+typedef uint32_t JournalEventId;
+
+enum KnownJournalEvent : JournalEventId {
+#define GEN_ENUM(name) Journal_##name,
+    ENUM_JOURNAL_EVENTS(GEN_ENUM)
+#undef GEN_ENUM
+    N_KnownJournalEvents
+};
+
+constexpr JournalEventId INVALID_JOURNAL_EVENT = UINT32_MAX;
+
+
+// Interns journal event names. Lookups go through a perfect hash of all the
+// names interned so far, rebuilt once per call that adds names and swapped
+// atomically: one string hash, two probes and one compare, without allocation.
+// Ids are never reused, a name keeps its id for the lifetime of the table.
+class JournalEventIds
+{
+public:
+    JournalEventIds();
+
+    JournalEventIds(const JournalEventIds&) = delete;
+    JournalEventIds& operator=(const JournalEventIds&) = delete;
+
+    // Id of the name, added if new. Meant for loading, not for dispatch.
+    JournalEventId intern(std::string_view name);
+
+    // Same for several names, the hash is built once: prefer it when loading
+    std::vector<JournalEventId> internAll(const std::vector<std::string_view>& names);
+
+    // INVALID_JOURNAL_EVENT if the name was never interned. Thread safe.
+    JournalEventId find(std::string_view name) const;
+
+    // Valid ids only, the reference stays valid
+    const std::string& getName(JournalEventId id) const;
+
+    // Ids are below this
+    size_t size() const;
+
+private:
+    // Hash and displace: the names are spread in buckets, each bucket has
+    // the displacement that puts its names in free slots
+    struct Table {
+        uint64_t seed = 0;
+        uint64_t bucketMask = 0;
+        uint32_t slotShift = 64;
+        std::vector<uint32_t> displacements;
+        std::vector<JournalEventId> slots;
+        std::vector<const std::string*> names;
+
+        size_t slotOf(uint64_t h) const;
+    };
+
+    // Tried per bucket before changing the seed
+    static constexpr uint32_t MAX_DISPLACEMENT = 1 << 16;
+
+    static uint64_t hash(std::string_view name, uint64_t seed);
+    static bool place(Table& table, const std::vector<uint64_t>& hashes);
+    static std::shared_ptr<const Table> build(const std::vector<const std::string*>& names);
+
+    // Append only, so that the tables can point into it
+    std::deque<std::string> _names;
+    std::mutex _internMutex;
+
+    std::shared_ptr<const Table> _table;
+};
\ No newline at end of file
@@ -5,8 +5,11 @@
 #ifdef BUILD_MEDICORP
 
 #include <string>
+#include <vector>
 #include <json.hpp>
 
+#include "../watchers/JournalEvent.h"
+
 class MedicCompliant
 {
 public:
@@ -14,7 +17,10 @@ public:
 
     void setShipID(const std::string& shipIdent);
 
-    void update(const std::string& event, const std::string& journalEntry);
+    // Journal events needed to restore the compliance at startup
+    static std::vector<std::vector<std::string>> getPrimingGroups();
+
+    void update(const JournalEvent& journalEvent);
 
     void validateModules(const nlohmann::json& modules);
 
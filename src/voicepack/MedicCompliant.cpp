@@ -17,24 +17,33 @@ void MedicCompliant::setShipID(const std::string& shipIdent)
 }
 
 
-void MedicCompliant::update(const std::string& event, const std::string& journalEntry) {
-    const nlohmann::json json = nlohmann::json::parse(journalEntry);
+std::vector<std::vector<std::string>> MedicCompliant::getPrimingGroups()
+{
+    return {
+        { "Loadout" },
+        { "SetUserShipName", "Loadout" }
+    };
+}
+
+
+void MedicCompliant::update(const JournalEvent& journalEvent) {
+    const std::string_view event = journalEvent.getEvent();
 
     if (event == "Loadout") {
-        if (json.contains("ShipIdent")) {
-            const std::string shipIdent = json["ShipIdent"].get<std::string>();
-            setShipID(shipIdent);
+        const nlohmann::json& json = journalEvent.getJson();
+
+        if (const std::optional<std::string> shipIdent = journalEvent.getField<std::string>({ "ShipIdent" })) {
+            setShipID(*shipIdent);
         }
 
-        if (json.contains("Modules")) {
-            const auto& modules = json["Modules"];
-            validateModules(modules);
+        // Not an object if the line is not valid JSON
+        if (json.is_object() && json.contains("Modules") && json["Modules"].is_array()) {
+            validateModules(json["Modules"]);
         }
     }
     else if (event == "SetUserShipName") {
-        if (json.contains("UserShipId")) {
-            const std::string shipIdent = json["UserShipId"].get<std::string>();
-            setShipID(shipIdent);
+        if (const std::optional<std::string> shipIdent = journalEvent.getField<std::string>({ "UserShipId" })) {
+            setShipID(*shipIdent);
         }
     }
 }
@@ -45,15 +54,13 @@ void MedicCompliant::validateModules(const nlohmann::json& modules)
     hasWeapons = false;
 
     for (const auto& module : modules) {
-        if (module.contains("Slot")) {
-            const std::string slotName = module["Slot"].get<std::string>();
+        if (const std::optional<std::string> slot = JournalEvent::getField<std::string>(module, { "Slot" })) {
+            const std::string& slotName = *slot;
 
             // Check for TinyHardpoint first, they can be legal
             if (slotName.find("TinyHardpoint") != std::string::npos) {
-                if (module.contains("Item")) {
-                    const std::string item = module["Item"].get<std::string>();
-
-                    if (item.find("defence_turret") != std::string::npos) {
+                if (const std::optional<std::string> item = JournalEvent::getField<std::string>(module, { "Item" })) {
+                    if (item->find("defence_turret") != std::string::npos) {
                         hasWeapons = true;
                     }
                 }
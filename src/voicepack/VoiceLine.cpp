@@ -1,7 +1,9 @@
 #include "VoiceLine.h"
 #include <cassert>
 #include <cstdint>
+#include <iostream>
 
+#include "AudioPlayer.h"
 #include "../util/EliteFileUtil.h"
 
 
@@ -28,43 +30,23 @@ bool VoiceLine::empty() const
 }
 
 
-std::optional<std::filesystem::path> VoiceLine::getNextVoiceline()
+void VoiceLine::setPriority(std::optional<VoicePriority> priority, int ttlMs)
 {
-    _hasBeenPlayedOnce = true;
-    _lastPlayed = std::chrono::steady_clock::now();
-
-    if (_filepath.size() == 0) {
-        // This is an error, shall not happen, silently ignore
-        assert(0);
-        return {};
-    }
-
-    if (_filepath.size() == 1) {
-        return _filepath[0];
-    }
-
-    const float sample = (float)std::rand() / (float)RAND_MAX;
-
-    // Use CDF to select a file
-    for (size_t i = 0; i < _cdf.size(); i++) {
-        if (sample <= _cdf[i]) {
-            return _filepath[i];
-        }
-    }
-
-    assert(0);
-
-    // Fallback, should not reach here
-    return _filepath.back();
+    _priority = priority;
+    _ttlMs = (ttlMs >= 0) ? ttlMs : -1;
 }
 
 
 void VoiceLine::loadFromJson(const std::filesystem::path& basePath, const nlohmann::json& json)
 {
     _filepath.clear();
+    _clips.clear();
     _probabilities.clear();
-    _cdf.clear();
     _cooldownMs = 0;
+    _priority.reset();
+    _ttlMs = -1;
+    _overlay = false;
+    _shuffle = false;
 
     // Simple case: backward compatibility with single string
     if (json.is_string()) {
@@ -102,16 +84,38 @@ void VoiceLine::loadFromJson(const std::filesystem::path& basePath, const nlohma
                     _cooldownMs = cd;
                 }
             }
+
+            if (json.contains("priority") && json["priority"].is_string()) {
+                _priority = voicePriorityFromString(json["priority"].get<std::string>());
+
+                if (!_priority) {
+                    std::cout << "[WARN  ] Unknown voiceline priority: " << json["priority"].get<std::string>() << std::endl;
+                }
+            }
+
+            if (json.contains("overlay") && json["overlay"].is_boolean()) {
+                _overlay = json["overlay"].get<bool>();
+            }
+
+            if (json.contains("shuffle") && json["shuffle"].is_boolean()) {
+                _shuffle = json["shuffle"].get<bool>();
+            }
+
+            // Milliseconds the line may wait before being dropped, 0 never expires
+            if (json.contains("ttl") && json["ttl"].is_number_integer()) {
+                const int ttl = json["ttl"].get<int>();
+                if (ttl >= 0) {
+                    _ttlMs = ttl;
+                }
+            }
         }
     }
-
-    computeCDF();
 }
 
 
 void VoiceLine::saveToJson(nlohmann::json& json) const
 {
-    if (_filepath.size() == 1 && _probabilities.size() == 1 && _probabilities[0] == 1.0f && _cooldownMs == 0) {
+    if (_filepath.size() == 1 && _probabilities.size() == 1 && _probabilities[0] == 1.0f && _cooldownMs == 0 && !_priority && _ttlMs < 0 && !_overlay && !_shuffle) {
         // Simple case: backward compatibility with single string
         json = _filepath[0].string();
     }
@@ -136,13 +140,29 @@ void VoiceLine::saveToJson(nlohmann::json& json) const
         if (_cooldownMs > 0) {
             json["cooldown"] = _cooldownMs;
         }
+
+        if (_priority) {
+            json["priority"] = voicePriorityToString(*_priority);
+        }
+
+        if (_ttlMs >= 0) {
+            json["ttl"] = _ttlMs;
+        }
+
+        if (_overlay) {
+            json["overlay"] = true;
+        }
+
+        if (_shuffle) {
+            json["shuffle"] = true;
+        }
     }
 }
 
 
 bool VoiceLine::removeMissingFiles()
 {
-    bool recompute = false;
+    bool removed = false;
 
     for (size_t i = 0; i < _filepath.size(); ) {
         if (_filepath[i].empty() || !std::filesystem::exists(_filepath[i])) {
@@ -151,46 +171,40 @@ bool VoiceLine::removeMissingFiles()
             if (i < _probabilities.size()) {
                 _probabilities.erase(_probabilities.begin() + i);
             }
-            recompute = true;
+
+            if (i < _clips.size()) {
+                _clips.erase(_clips.begin() + i);
+            }
+            removed = true;
         }
         else {
             i++;
         }
     }
 
-    if (recompute) {
-        computeCDF();
-    }
-
-    return recompute;
+    return removed;
 }
 
 
-bool VoiceLine::hasCooledDown() const
+void VoiceLine::setVariants(
+    std::vector<std::filesystem::path>&& filepath,
+    std::vector<float>&& probabilities,
+    std::vector<AudioClipId>&& clips,
+    int cooldownMs)
 {
-    if (!_hasBeenPlayedOnce || _cooldownMs == 0.f) {
-        return true;
-    }
-
-    const auto now = std::chrono::steady_clock::now();
-    const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - _lastPlayed).count();
-
-    return elapsedMs >= _cooldownMs;
+    _filepath = std::move(filepath);
+    _probabilities = std::move(probabilities);
+    _clips = std::move(clips);
+    _cooldownMs = (cooldownMs > 0) ? cooldownMs : 0;
 }
 
 
-void VoiceLine::computeCDF()
+void VoiceLine::loadClips(AudioPlayer& player)
 {
-    _cdf.clear();
-    float sum = 0.0f;
-
-    for (const auto& p : _probabilities) {
-        sum += p;
-        _cdf.push_back(sum);
-    }
+    _clips.clear();
+    _clips.reserve(_filepath.size());
 
-    // Normalize CDF
-    for (auto& c : _cdf) {
-        c /= sum;
+    for (const auto& path : _filepath) {
+        _clips.push_back(player.loadClip(path));
     }
 }
\ No newline at end of file
@@ -3,12 +3,17 @@
 #include <vector>
 #include <filesystem>
 #include <string>
-#include <random>
-#include <chrono>
 #include <optional>
 
 #include <json.hpp>
 
+#include "AudioClip.h"
+#include "Enum.h"
+
+class AudioPlayer;
+
+// A voiceline as described by the voicepack. Compiled into a
+// VoiceTriggerTable once the voicepack is loaded.
 struct VoiceLine
 {
 public:
@@ -18,23 +23,53 @@ public:
     int getCooldownMs() const;
     bool empty() const;
 
-    std::optional<std::filesystem::path> getNextVoiceline();
+    // Used when the voicepack does not give a priority
+    void setDefaultPriority(VoicePriority priority) { _defaultPriority = priority; }
+    VoicePriority getDefaultPriority() const { return _defaultPriority; }
+
+    // ttlMs < 0: default of the priority
+    void setPriority(std::optional<VoicePriority> priority, int ttlMs);
+    std::optional<VoicePriority> getPriority() const { return _priority; }
+    int getTtlMs() const { return _ttlMs; }
+
+    // Overlays are short tones played over speech without queueing
+    void setOverlay(bool overlay) { _overlay = overlay; }
+    bool isOverlay() const { return _overlay; }
+
+    // Variants drawn in turn from a shuffled bag rather than by probability,
+    // no variant plays twice in a row
+    void setShuffle(bool shuffle) { _shuffle = shuffle; }
+    bool isShuffle() const { return _shuffle; }
 
     void loadFromJson(const std::filesystem::path& basePath, const nlohmann::json& json);
     void saveToJson(nlohmann::json& json) const;
 
     bool removeMissingFiles();
 
-    bool hasCooledDown() const;
+    // Variants already registered in the player, from a voicepack bundle
+    void setVariants(
+        std::vector<std::filesystem::path>&& filepath,
+        std::vector<float>&& probabilities,
+        std::vector<AudioClipId>&& clips,
+        int cooldownMs);
 
-private:
-    void computeCDF();
+    const std::vector<std::filesystem::path>& getFiles() const { return _filepath; }
+    const std::vector<float>& getProbabilities() const { return _probabilities; }
+    const std::vector<AudioClipId>& getClips() const { return _clips; }
+
+    // Registers all the variants, once per file in the player
+    void loadClips(AudioPlayer& player);
 
+private:
     std::vector<std::filesystem::path> _filepath;
+    std::vector<AudioClipId> _clips;
     std::vector<float> _probabilities;
-    std::vector<float> _cdf;
 
     int _cooldownMs = 0;
-    std::chrono::steady_clock::time_point _lastPlayed;
-    bool _hasBeenPlayedOnce = false;
+
+    std::optional<VoicePriority> _priority;
+    VoicePriority _defaultPriority = Normal;
+    int _ttlMs = -1;
+    bool _overlay = false;
+    bool _shuffle = false;
 };
@@ -4,9 +4,36 @@
 #include <sstream>
 #include <json.hpp>
 
+#include "VoicePackBundle.h"
 #include "VoicePackManager.h"
 #include "VoicePackUtil.h"
 
+
+// Alerts decoded at load and never evicted, they must play without delay
+// and interrupt any other line
+static const std::array<SpecialEvent, 4> CRITICAL_SPECIAL_EVENTS = {
+    HullIntegrity_Critical,
+    HullIntegrity_Compromised,
+    Fuel_Critical,
+    Oxygen_Critical
+};
+
+// Part of the main tank, the Low_Fuel flag is raised at 25%
+static constexpr double FUEL_CRITICAL_RATIO = 0.1;
+
+// Oxygen is in [0, 1], the Low_Oxygen flag is raised before
+static constexpr double OXYGEN_CRITICAL = 0.1;
+
+static const std::array<StatusEvent, 6> CRITICAL_STATUS_EVENTS = {
+    Low_Fuel,
+    Over_Heating,
+    Being_Interdicted,
+    IsInDanger,
+    Low_Oxygen,
+    Low_Health
+};
+
+
 VoicePack::VoicePack(VoicePackManager& voicepackManager)
     : _voicePackManager(voicepackManager)
     , _currVehicle(Vehicle::Ship)
@@ -21,12 +48,6 @@ VoicePack::VoicePack(VoicePackManager& voicepackManager)
     , _isShutdownState(false)
     , _isPriming(false)
 {
-    for (auto& vs : _voiceStatus) {
-        vs.fill(VoiceLine());
-    }
-
-    _voiceSpecial.fill(VoiceLine());
-
     for (auto& va : _voiceStatusActive) {
         va.fill(Undefined);
     }
@@ -35,17 +56,19 @@ VoicePack::VoicePack(VoicePackManager& voicepackManager)
 }
 
 
+VoicePack::~VoicePack()
+{
+    unpinClips();
+}
+
+
 void VoicePack::loadConfig(const std::filesystem::path& filepath)
 {
     _configPath = filepath;
 
     // Clear current configuration
-    for (auto& vs : _voiceStatus) {
-        vs.fill(VoiceLine());
-    }
-    
-    _voiceSpecial.fill(VoiceLine());
-    _voiceJournal.clear();
+    unpinClips();
+    _triggers.clear();
 
     for (auto& va : _voiceStatusActive) {
         va.fill(Undefined);
@@ -61,58 +84,29 @@ void VoicePack::loadConfig(const std::filesystem::path& filepath)
 
     std::cout << "[INFO  ] Loading voicepack: " << filepath << std::endl;
 
-    std::filesystem::path basePath;
+    // Only kept while loading, compiled into the trigger table
+    std::unique_ptr<VoicePackLines> lines = std::make_unique<VoicePackLines>();
 
-    if (filepath.is_absolute()) {
-        basePath = filepath.parent_path();
+    if (VoicePackBundle::isBundle(filepath)) {
+        loadBundle(filepath, *lines);
     }
     else {
-        basePath = std::filesystem::current_path() / filepath.parent_path();
+        loadJson(filepath, *lines);
     }
 
-    try {
-        std::ifstream file(filepath);
-        std::string fileContent((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    setDefaultPriorities(*lines);
 
-        nlohmann::json json = nlohmann::json::parse(fileContent);
+    _triggers.build(*lines, _voicePackManager.getRandomSeed());
+    updateActiveTriggers();
 
-        // Parse status
-        if (json.contains("status")) {
-            // Load common status config
-            for (size_t v = 0; v < N_Vehicles; v++) {
-                loadStatusConfig(basePath, json["status"], _voiceStatus[v]);
-            }
-
-            for (size_t v = 0; v < N_Vehicles; v++) {
-                const std::string vehicleName = vehicleToString((Vehicle)v);
-                if (json["status"].contains(vehicleName)) {
-                    loadStatusConfig(basePath, json["status"][vehicleName], _voiceStatus[v]);
-                }
-            }
-        }
-
-        // Parse journal
-        if (json.contains("event")) {
-            for (auto& je : json["event"].items()) {
-                _voiceJournal[je.key()] = VoiceLine(basePath, je.value());
-            }
-        }
+    prefetchClips();
+}
 
-        // Parse journal
-        if (json.contains("special")) {
-            for (auto& je : json["special"].items()) {
-                const std::optional<SpecialEvent> se = specialEventFromString(je.key());
 
-                if (se.has_value()) {
-                    if (*se != SpecialEvent::N_SpecialEvents) {
-                        _voiceSpecial[*se].loadFromJson(basePath, je.value());
-                    }
-                }
-            }
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "[ERR] JSON: " << e.what() << "\n";
-    }
+void VoicePack::loadJson(const std::filesystem::path& filepath, VoicePackLines& lines)
+{
+    std::map<std::string, VoiceLine> voiceJournal;
+    VoicePackJson::load(filepath, lines.status, voiceJournal, lines.special);
 
     // Log missing files and remove them from the list
     for (size_t iEvent = 0; iEvent < StatusEvent::N_StatusEvents; iEvent++) {
@@ -123,14 +117,14 @@ void VoicePack::loadConfig(const std::filesystem::path& filepath)
             const size_t index = 2 * iEvent + i;
 
             for (size_t v = 0; v < N_Vehicles; v++) {
-                if (!_voiceStatus[v][index].empty()) {
-                    const bool hasMissingFiles = _voiceStatus[v][index].removeMissingFiles();
+                if (!lines.status[v][index].empty()) {
+                    const bool hasMissingFiles = lines.status[v][index].removeMissingFiles();
 
                     if (hasMissingFiles) {
                         std::cout << "[ERR   ] Missing file for status '" << eventName << "' (" << state << ") vehicle '" << vehicleToString((Vehicle)v) << std::endl;
                     }
 
-                    if (_voiceStatus[v][index].empty()) {
+                    if (lines.status[v][index].empty()) {
                         _voiceStatusActive[v][index] = MissingFile;
                     }                    
                     else {
@@ -144,7 +138,19 @@ void VoicePack::loadConfig(const std::filesystem::path& filepath)
         }
     }
 
-    for (auto& [eventName, voicelines] : _voiceJournal) {
+    // Interned at once, the lookup table is built a single time
+    std::vector<std::string_view> journalNames;
+
+    for (const auto& [eventName, voicelines] : voiceJournal) {
+        journalNames.push_back(eventName);
+    }
+
+    const std::vector<JournalEventId> journalIds = _voicePackManager.getJournalEventIds().internAll(journalNames);
+    size_t iJournal = 0;
+
+    for (auto& [eventName, voicelines] : voiceJournal) {
+        const size_t index = journalIndex(lines, journalIds[iJournal++]);
+
         if (!voicelines.empty()) {
             const bool hasMissingFiles = voicelines.removeMissingFiles();
 
@@ -153,22 +159,24 @@ void VoicePack::loadConfig(const std::filesystem::path& filepath)
             }
 
             if (voicelines.empty()) {
-                _voiceJournalActive[eventName] = MissingFile;
+                _voiceJournalActive[index] = MissingFile;
             }
             else {
-                _voiceJournalActive[eventName] = Active;
+                _voiceJournalActive[index] = Active;
             }
         }
         else {
             // Should not happen
             assert(0);
-            _voiceJournalActive[eventName] = Undefined;
+            _voiceJournalActive[index] = Undefined;
         }
+
+        lines.journal[index] = std::move(voicelines);
     }
 
     for (size_t iSpecial = 0; iSpecial < SpecialEvent::N_SpecialEvents; iSpecial++) {
         const std::string eventName = specialEventToString((SpecialEvent)iSpecial);
-        auto& path = _voiceSpecial[iSpecial];
+        auto& path = lines.special[iSpecial];
 
         if (!path.empty()) {
             const bool hasMissingFiles = path.removeMissingFiles();
@@ -188,6 +196,238 @@ void VoicePack::loadConfig(const std::filesystem::path& filepath)
             _voiceSpecialActive[iSpecial] = Undefined;
         }
     }
+
+    loadClips(lines);
+}
+
+
+void VoicePack::loadBundle(const std::filesystem::path& filepath, VoicePackLines& lines)
+{
+#ifdef USE_SDL_MIXER
+    const VoicePackBundle& bundle = _voicePackManager.openBundle(filepath);
+    const BundleHeader& header = bundle.getHeader();
+    AudioPlayer& player = _voicePackManager.getAudioPlayer();
+
+    // PCM is played straight from the mapping, a clip can be shared by several lines
+    std::vector<AudioClipId> clips(header.clipCount);
+    const std::string clipPrefix = filepath.string() + "#";
+
+    for (uint32_t i = 0; i < header.clipCount; i++) {
+        const BundleClip& clip = bundle.getClips()[i];
+        clips[i] = player.loadRawClip(clipPrefix + std::to_string(i), bundle.getPCM(clip), clip.bytes, header.audioFormat, header.channels, header.freq);
+    }
+
+    // Interned at once, the lookup table is built a single time
+    std::vector<uint32_t> journalLines;
+    std::vector<std::string_view> journalNames;
+
+    for (uint32_t iLine = 0; iLine < header.lineCount; iLine++) {
+        const BundleLine& line = bundle.getLines()[iLine];
+
+        if (line.kind == BundleLine::Journal) {
+            journalLines.push_back(iLine);
+            journalNames.push_back(bundle.getString(line.nameOffset));
+        }
+    }
+
+    const std::vector<JournalEventId> internedIds = _voicePackManager.getJournalEventIds().internAll(journalNames);
+    std::vector<JournalEventId> journalIds(header.lineCount, INVALID_JOURNAL_EVENT);
+
+    for (size_t i = 0; i < journalLines.size(); i++) {
+        journalIds[journalLines[i]] = internedIds[i];
+    }
+
+    for (uint32_t iLine = 0; iLine < header.lineCount; iLine++) {
+        const BundleLine& line = bundle.getLines()[iLine];
+        const std::string name(bundle.getString(line.nameOffset));
+
+        std::vector<std::filesystem::path> files;
+        std::vector<float> probabilities;
+        std::vector<AudioClipId> lineClips;
+
+        for (uint32_t i = line.firstVariant; i < line.firstVariant + line.variantCount; i++) {
+            const BundleVariant& variant = bundle.getVariants()[i];
+
+            if (clips[variant.clip] != INVALID_AUDIO_CLIP) {
+                files.emplace_back(bundle.getString(variant.fileOffset));
+                probabilities.push_back(variant.probability);
+                lineClips.push_back(clips[variant.clip]);
+            }
+        }
+
+        VoiceLine* voiceline = nullptr;
+        VoiceTriggerStatus* active = nullptr;
+
+        switch (line.kind) {
+        case BundleLine::Status: {
+            const std::optional<StatusEvent> status = statusFromString(name);
+
+            if (status && *status != StatusEvent::N_StatusEvents && line.vehicle < N_Vehicles && line.state < 2) {
+                voiceline = &lines.status[line.vehicle][2 * *status + line.state];
+                active = &_voiceStatusActive[line.vehicle][2 * *status + line.state];
+            }
+            break;
+        }
+        case BundleLine::Journal: {
+            const size_t index = journalIndex(lines, journalIds[iLine]);
+
+            voiceline = &lines.journal[index];
+            active = &_voiceJournalActive[index];
+            break;
+        }
+        case BundleLine::Special: {
+            const std::optional<SpecialEvent> special = specialEventFromString(name);
+
+            if (special && *special != SpecialEvent::N_SpecialEvents) {
+                voiceline = &lines.special[*special];
+                active = &_voiceSpecialActive[*special];
+            }
+            break;
+        }
+        }
+
+        if (!voiceline) {
+            std::cout << "[WARN  ] Unknown event in voicepack bundle: " << name << std::endl;
+            continue;
+        }
+
+        voiceline->setVariants(std::move(files), std::move(probabilities), std::move(lineClips), line.cooldownMs);
+
+        if (line.priority < N_VoicePriorities) {
+            voiceline->setPriority((VoicePriority)line.priority, line.ttlMs);
+        }
+        else {
+            voiceline->setPriority(std::nullopt, line.ttlMs);
+        }
+
+        voiceline->setOverlay((line.flags & BundleLine::Overlay) != 0);
+        voiceline->setShuffle((line.flags & BundleLine::Shuffle) != 0);
+        *active = voiceline->empty() ? MissingFile : Active;
+    }
+
+    std::cout << "[INFO  ] Mapped " << header.lineCount << " voicelines and " << header.clipCount << " clips from bundle" << std::endl;
+#else
+    // Media Foundation only plays files
+    throw std::runtime_error("VoicePack: Voicepack bundles need the SDL Mixer audio backend: " + filepath.string());
+#endif
+}
+
+
+size_t VoicePack::journalIndex(VoicePackLines& lines, JournalEventId id)
+{
+    if (id >= lines.journal.size()) {
+        lines.journal.resize(id + 1);
+    }
+
+    if (id >= _voiceJournalActive.size()) {
+        _voiceJournalActive.resize(id + 1, Undefined);
+    }
+
+    return id;
+}
+
+
+void VoicePack::setDefaultPriorities(VoicePackLines& lines)
+{
+    for (SpecialEvent event : CRITICAL_SPECIAL_EVENTS) {
+        lines.special[event].setDefaultPriority(Critical);
+    }
+
+    for (auto& voiceStatus : lines.status) {
+        for (StatusEvent event : CRITICAL_STATUS_EVENTS) {
+            voiceStatus[2 * event + 1].setDefaultPriority(Critical);
+        }
+    }
+}
+
+
+void VoicePack::loadClips(VoicePackLines& lines)
+{
+    // Clips are decoded on first use or prefetched in the background within
+    // the cache budget. Critical alerts are prefetched first and pinned.
+    AudioPlayer& player = _voicePackManager.getAudioPlayer();
+
+    for (auto& voiceStatus : lines.status) {
+        for (auto& voiceline : voiceStatus) {
+            voiceline.loadClips(player);
+        }
+    }
+
+    for (auto& voiceline : lines.journal) {
+        voiceline.loadClips(player);
+    }
+
+    for (auto& voiceline : lines.special) {
+        voiceline.loadClips(player);
+    }
+}
+
+
+void VoicePack::prefetchClips()
+{
+    AudioPlayer& player = _voicePackManager.getAudioPlayer();
+    _clipsPinned = true;
+
+    for (SpecialEvent event : CRITICAL_SPECIAL_EVENTS) {
+        _triggers.prefetchClips(player, VoiceTriggerTable::specialTrigger(event), true);
+    }
+
+    for (size_t v = 0; v < N_Vehicles; v++) {
+        for (StatusEvent event : CRITICAL_STATUS_EVENTS) {
+            _triggers.prefetchClips(player, VoiceTriggerTable::statusTrigger((Vehicle)v, 2 * event + 1), true);
+        }
+    }
+
+    for (size_t iSpecial = 0; iSpecial < N_SpecialEvents; iSpecial++) {
+        _triggers.prefetchClips(player, VoiceTriggerTable::specialTrigger((SpecialEvent)iSpecial), false);
+    }
+
+    for (VoiceTriggerTable::TriggerId trigger = 0; trigger < VoiceTriggerTable::N_STATUS_TRIGGERS; trigger++) {
+        _triggers.prefetchClips(player, trigger, false);
+    }
+
+    for (VoiceTriggerTable::TriggerId trigger = VoiceTriggerTable::FIRST_JOURNAL_TRIGGER; trigger < _triggers.size(); trigger++) {
+        _triggers.prefetchClips(player, trigger, false);
+    }
+}
+
+
+void VoicePack::unpinClips()
+{
+    if (!_clipsPinned) {
+        return;
+    }
+
+    AudioPlayer& player = _voicePackManager.getAudioPlayer();
+    _clipsPinned = false;
+
+    for (SpecialEvent event : CRITICAL_SPECIAL_EVENTS) {
+        _triggers.unpinClips(player, VoiceTriggerTable::specialTrigger(event));
+    }
+
+    for (size_t v = 0; v < N_Vehicles; v++) {
+        for (StatusEvent event : CRITICAL_STATUS_EVENTS) {
+            _triggers.unpinClips(player, VoiceTriggerTable::statusTrigger((Vehicle)v, 2 * event + 1));
+        }
+    }
+}
+
+
+void VoicePack::updateActiveTriggers()
+{
+    for (size_t v = 0; v < N_Vehicles; v++) {
+        for (size_t index = 0; index < 2 * StatusEvent::N_StatusEvents; index++) {
+            _triggers.setActive(VoiceTriggerTable::statusTrigger((Vehicle)v, index), _voiceStatusActive[v][index] == Active);
+        }
+    }
+
+    for (size_t iSpecial = 0; iSpecial < N_SpecialEvents; iSpecial++) {
+        _triggers.setActive(VoiceTriggerTable::specialTrigger((SpecialEvent)iSpecial), _voiceSpecialActive[iSpecial] == Active);
+    }
+
+    for (JournalEventId id = 0; id < _voiceJournalActive.size(); id++) {
+        _triggers.setActive(VoiceTriggerTable::journalTrigger(id), _voiceJournalActive[id] == Active);
+    }
 }
 
 
@@ -207,24 +447,74 @@ void VoicePack::onStatusChanged(StatusEvent event, bool status)
     }
 
     const size_t index = 2 * event + (status ? 1 : 0);
+    const std::optional<VoiceRequest> request = _triggers.trigger(VoiceTriggerTable::statusTrigger(_currVehicle, index));
+
+    if (request) {
+        _voicePackManager.playStatusVoiceline(_currVehicle, event, status, request.value());
+    }
+}
 
-    if (_voiceStatusActive[_currVehicle][index] == Active &&
-        _voiceStatus[_currVehicle][index].hasCooledDown()) {
 
-        const auto& soundPath = _voiceStatus[_currVehicle][index].getNextVoiceline();
+StatusFieldMask VoicePack::getStatusFields()
+{
+    return StatusFieldUtil::toMask(FuelMain);
+}
 
-        if (soundPath) {
-            _voicePackManager.playStatusVoiceline(_currVehicle, event, status, soundPath.value());
+
+std::vector<StatusThreshold> VoicePack::getStatusThresholds()
+{
+    return {
+        { Oxygen, StatusThreshold::Below, OXYGEN_CRITICAL }
+    };
+}
+
+
+void VoicePack::onStatusFieldsChanged(const StatusSnapshot& previous, const StatusSnapshot& current, StatusFieldMask changedMask)
+{
+    // The capacity of the tank comes from Loadout, Status.json gives tons
+    if ((changedMask & StatusFieldUtil::toMask(FuelMain)) &&
+        _currVehicle == Vehicle::Ship &&
+        _maxShipFuel > 0 &&
+        previous.has(FuelMain) &&
+        current.has(FuelMain)) {
+        const double critical = FUEL_CRITICAL_RATIO * _maxShipFuel;
+
+        if (previous.values[FuelMain] >= critical && current.values[FuelMain] < critical) {
+            onSpecialEvent(Fuel_Critical);
         }
     }
 }
 
 
-void VoicePack::setJournalPreviousEvent(const std::string& event, const std::string& journalEntry)
+void VoicePack::onStatusThreshold(const StatusThreshold& threshold, double value)
+{
+    if (threshold.field == Oxygen && threshold.direction == StatusThreshold::Below) {
+        onSpecialEvent(Oxygen_Critical);
+    }
+}
+
+
+std::vector<std::vector<std::string>> VoicePack::getPrimingGroups()
+{
+    return {
+        { "Shutdown", "LoadGame" },
+        { "Disembark", "Embark", "LaunchSRV", "DockSRV", "LoadGame" },
+        { "LaunchSRV", "LoadGame" },
+        { "Loadout" },
+        { "Cargo" }
+    };
+}
+
+
+void VoicePack::setJournalPreviousEvent(const JournalEvent& journalEvent, JournalEventId id)
 {
     // Ensure we're updating player status silently (no voiceline triggered)
-    onJournalEvent(event, journalEntry);
+    onJournalEvent(journalEvent, id);
+}
 
+
+void VoicePack::onJournalPrimingDone()
+{
     // Just for debugging
     std::cout << "[INFO  ] Priming done. Current vehicle: " << vehicleToString(_currVehicle)
               << ", Ship cargo: " << _currShipCargo << "/" << _maxShipCargo
@@ -236,33 +526,33 @@ void VoicePack::setJournalPreviousEvent(const std::string& event, const std::str
 
 
 
-void VoicePack::onJournalEvent(const std::string& event, const std::string& journalEntry)
+void VoicePack::onJournalEvent(const JournalEvent& journalEvent, JournalEventId id)
 {
-    if (event == "Shutdown") {
+    if (id == Journal_Shutdown) {
         _isShutdownState = true;
         std::cout << "[INFO  ] Entering shutdown state" << std::endl;
     }
-    else if (event == "LoadGame") {
+    else if (id == Journal_LoadGame) {
         _isShutdownState = false;
         std::cout << "[INFO  ] Exiting shutdown state" << std::endl;
     }
 
     // Prevent multiple "under attack" announcements
-    if (_previousUnderAttack && event == "UnderAttack") {
+    if (_previousUnderAttack && id == Journal_UnderAttack) {
         return;
     }
 
-    _previousUnderAttack = (event == "UnderAttack");
-    _previousLaunchDrone = (event == "LaunchDrone");
+    _previousUnderAttack = (id == Journal_UnderAttack);
+    _previousLaunchDrone = (id == Journal_LaunchDrone);
 
     // Prevent mutilple "cargo scoop deployed" announcements
     // Not reliable for EjectCargo though...
-    if (event == "LaunchDrone") {
+    if (id == Journal_LaunchDrone) {
         _previousLaunchDrone = true;
         std::cout << "[INFO  ] LaunchDrone event received, setting launch state." << std::endl;
     }
 
-    if (event == "EjectCargo") {
+    if (id == Journal_EjectCargo) {
         _previousEjectCargo = true;
         std::cout << "[INFO  ] EjectCargo event received, setting eject state." << std::endl;
     }
@@ -270,33 +560,31 @@ void VoicePack::onJournalEvent(const std::string& event, const std::string& jour
     // Reset voiceline reading when receiving the acknowledgment
     // from "Cargo" event
     if (_previousEjectCargo || _previousLaunchDrone) {
-        if (event == "Cargo") {
+        if (id == Journal_Cargo) {
             _previousEjectCargo = false;
             _previousLaunchDrone = false;
             std::cout << "[INFO  ] Cargo update received, resetting launch/eject state." << std::endl;
         }
     }
 
-    auto it = _voiceJournal.find(event);
+    if (id != INVALID_JOURNAL_EVENT) {
+        const std::optional<VoiceRequest> request = _triggers.trigger(VoiceTriggerTable::journalTrigger(id));
 
-    if (it != _voiceJournal.end() && _voiceJournalActive[event] == Active &&
-        it->second.hasCooledDown()) {
-        const auto& soundPath = it->second.getNextVoiceline();
-
-        if (soundPath) {
-            _voicePackManager.playJournalVoiceline(event, soundPath.value());
+        if (request) {
+            _voicePackManager.playJournalVoiceline(id, request.value());
         }
     }
 
-    const nlohmann::json json = nlohmann::json::parse(journalEntry);
-
+    // The JSON DOM is only built for the entries we need fields from. A
+    // field missing, of another type, or on a line that is not valid JSON
+    // is ignored.
+    switch (id) {
     // Check for cargo capacity change, there no specific event for max cargo change
-    if (event == "Loadout") {
+    case Journal_Loadout: {
         // Check for cargo capacity
-        if (json.contains("CargoCapacity")) {
-            const uint32_t cargo = json["CargoCapacity"].get<uint32_t>();
-            if (cargo != _maxShipCargo) {
-                _maxShipCargo = cargo;
+        if (const std::optional<uint32_t> cargo = journalEvent.getField<uint32_t>({ "CargoCapacity" })) {
+            if (*cargo != _maxShipCargo) {
+                _maxShipCargo = *cargo;
                 std::cout << "[INFO  ] New cargo capacity: " << _maxShipCargo << std::endl;
             }
 
@@ -306,27 +594,29 @@ void VoicePack::onJournalEvent(const std::string& event, const std::string& jour
             }
         }
         // Check for fuel capacity
-        if (json.contains("FuelCapacity") && json["FuelCapacity"].contains("Main")) {
-            _maxShipFuel = json["FuelCapacity"]["Main"].get<uint32_t>();
+        if (const std::optional<uint32_t> fuel = journalEvent.getField<uint32_t>({ "FuelCapacity", "Main" })) {
+            _maxShipFuel = *fuel;
         }
+        break;
     }
-    else if (event == "Cargo") {
+    case Journal_Cargo: {
+        const std::optional<uint32_t> cargo = journalEvent.getField<uint32_t>({ "Count" });
+        const std::optional<std::string> vessel = journalEvent.getField<std::string>({ "Vessel" });
+
         // Check for cargo change
-        if (json.contains("Count")) {
-            if (json.contains("Vessel")) {
-                const uint32_t cargo = json["Count"].get<uint32_t>();
-                if (json["Vessel"] == "Ship") {
-                    setShipCargo(cargo);
-                }
-                else if (json["Vessel"] == "SRV") {
-                    setSRVCargo(cargo);
-                }
+        if (cargo && vessel) {
+            if (*vessel == "Ship") {
+                setShipCargo(*cargo);
+            }
+            else if (*vessel == "SRV") {
+                setSRVCargo(*cargo);
             }
         }
+        break;
     }
-    else if (event == "CollectCargo") {
-        if (json.contains("Type")) {
-            const std::string cargoType = json["Type"].get<std::string>();
+    case Journal_CollectCargo: {
+        if (const std::optional<std::string> type = journalEvent.getField<std::string>({ "Type" })) {
+            const std::string& cargoType = *type;
 
             // We've collected an escape pod!
             if (VoicePackUtil::compareStrings(cargoType, _medicAcceptedPods)
@@ -336,34 +626,41 @@ void VoicePack::onJournalEvent(const std::string& event, const std::string& jour
                 onSpecialEvent(CollectPod);
             }
         }
+        break;
     }
     // On foot transitions
-    else if (event == "Disembark") {
+    case Journal_Disembark: {
         setCurrentVehicle(Vehicle::OnFoot);
+        break;
     }
-    else if (event == "Embark") {
-        if (json["SRV"].get<bool>()) {
+    case Journal_Embark: {
+        if (journalEvent.getField<bool>({ "SRV" }).value_or(false)) {
             setCurrentVehicle(Vehicle::SRV);
         }
         else {
             setCurrentVehicle(Vehicle::Ship);
         }
+        break;
     }
-    else if (event == "LaunchSRV") {
+    case Journal_LaunchSRV: {
         setCurrentVehicle(Vehicle::SRV);
 
-        if (json.contains("SRVType") && srvTypeFromString(json["SRVType"])) {
-            const SRVType srvType = srvTypeFromString(json["SRVType"]).value();
-            _maxSRVCargo = SRV_MAX_CARGO[srvType];
+        if (const std::optional<std::string> type = journalEvent.getField<std::string>({ "SRVType" })) {
+            const std::optional<SRVType> srvType = srvTypeFromString(*type);
+
+            if (srvType) {
+                _maxSRVCargo = SRV_MAX_CARGO[*srvType];
+            }
         }
+        break;
     }
-    else if (event == "DockSRV") {
+    case Journal_DockSRV: {
         setCurrentVehicle(Vehicle::Ship);
+        break;
     }
-    else if (event == "FuelScoop") {
-        if (json.contains("Total")) {
-            const uint32_t currentFuel = json["Total"].get<uint32_t>();
-            if (currentFuel == _maxShipFuel) {
+    case Journal_FuelScoop: {
+        if (const std::optional<uint32_t> currentFuel = journalEvent.getField<uint32_t>({ "Total" })) {
+            if (*currentFuel == _maxShipFuel) {
                 onSpecialEvent(FuelScoopFinished);
             }
             // This is removed, not reliable right now
@@ -373,33 +670,39 @@ void VoicePack::onJournalEvent(const std::string& event, const std::string& jour
             //    _canTriggerFuelScooping = false;
             //}
         }
+        break;
     }
-    else if (event == "ReservoirReplenished") {
-        if (json.contains("FuelMain")) {
-            const uint32_t currentFuel = json["FuelMain"].get<uint32_t>();
+    case Journal_ReservoirReplenished: {
+        if (const std::optional<uint32_t> currentFuel = journalEvent.getField<uint32_t>({ "FuelMain" })) {
             // TODO: special event at X% fuel?
         }
+        break;
     }
-    else if (event == "HullDamage") {
-        if (json.contains("Health")) {
-            const float health = json["Health"].get<float>();
-            if (health < 25E-2f) {
+    case Journal_HullDamage: {
+        if (const std::optional<float> health = journalEvent.getField<float>({ "Health" })) {
+            if (*health < 25E-2f) {
                 onSpecialEvent(HullIntegrity_Critical);
             }
             else {
                 onSpecialEvent(HullIntegrity_Compromised);
             }
         }
+        break;
     }
-    else if (event == "Liftoff") {
-        if (json.contains("PlayerControlled") && !json["PlayerControlled"].get<bool>()) {
+    case Journal_Liftoff: {
+        if (!journalEvent.getField<bool>({ "PlayerControlled" }).value_or(true)) {
             onSpecialEvent(AutoPilot_Liftoff);
         }
+        break;
     }
-    else if (event == "Touchdown") {
-        if (json.contains("PlayerControlled") && !json["PlayerControlled"].get<bool>()) {
+    case Journal_Touchdown: {
+        if (!journalEvent.getField<bool>({ "PlayerControlled" }).value_or(true)) {
             onSpecialEvent(AutoPilot_Touchdown);
         }
+        break;
+    }
+    default:
+        break;
     }
     //else if (event == "LaunchFighter") {
     //    _currentVehicule = Vehicle::Ship;
@@ -416,36 +719,37 @@ void VoicePack::onSpecialEvent(SpecialEvent event)
         return;
     }
 
-    if (_voiceSpecialActive[event] == Active &&
-        _voiceSpecial[event].hasCooledDown()) {
+    const std::optional<VoiceRequest> request = _triggers.trigger(VoiceTriggerTable::specialTrigger(event));
 
-        const auto& soundPath = _voiceSpecial[event].getNextVoiceline();
-
-        if (soundPath) {
-            _voicePackManager.playSpecialVoiceline(event, soundPath.value());
-        }
+    if (request) {
+        _voicePackManager.playSpecialVoiceline(event, request.value());
     }
 }
 
 
 void VoicePack::setVoiceStatusState(Vehicle vehicle, StatusEvent event, bool statusState, bool active)
 {
-    auto& it = _voiceStatusActive[vehicle][2 * event + (statusState ? 1 : 0)];
+    const size_t index = 2 * event + (statusState ? 1 : 0);
+    auto& it = _voiceStatusActive[vehicle][index];
 
     if (it != Undefined && it != MissingFile) {
         it = active ? Active : Inactive;
+        _triggers.setActive(VoiceTriggerTable::statusTrigger(vehicle, index), active);
     }
 }
 
 
-void VoicePack::setVoiceJournalState(const std::string& event, bool active)
+void VoicePack::setVoiceJournalState(JournalEventId event, bool active)
 {
-    auto it = _voiceJournalActive.find(event);
+    if (event >= _voiceJournalActive.size()) {
+        return;
+    }
+
+    auto& it = _voiceJournalActive[event];
 
-    if (it != _voiceJournalActive.end() &&
-        it->second != Undefined &&
-        it->second != MissingFile) {
-        it->second = active ? Active : Inactive;
+    if (it != Undefined && it != MissingFile) {
+        it = active ? Active : Inactive;
+        _triggers.setActive(VoiceTriggerTable::journalTrigger(event), active);
     }
 }
 
@@ -455,6 +759,34 @@ void VoicePack::setVoiceSpecialState(SpecialEvent event, bool active)
     auto& it = _voiceSpecialActive[event];
     if (it != Undefined && it != MissingFile) {
         it = active ? Active : Inactive;
+        _triggers.setActive(VoiceTriggerTable::specialTrigger(event), active);
+    }
+}
+
+
+void VoicePack::applyActivation(const VoiceActivation& activation)
+{
+    // Undefined or missing in the config: the voicepack default is kept
+    for (size_t v = 0; v < N_Vehicles; v++) {
+        for (size_t index = 0; index < 2 * StatusEvent::N_StatusEvents; index++) {
+            const VoiceTriggerStatus status = activation.status[v][index];
+
+            if (status == Active || status == Inactive) {
+                setVoiceStatusState((Vehicle)v, (StatusEvent)(index / 2), (index % 2) == 1, status == Active);
+            }
+        }
+    }
+
+    for (JournalEventId id = 0; id < activation.journal.size(); id++) {
+        if (activation.journal[id] == Active || activation.journal[id] == Inactive) {
+            setVoiceJournalState(id, activation.journal[id] == Active);
+        }
+    }
+
+    for (size_t iEvent = 0; iEvent < N_SpecialEvents; iEvent++) {
+        if (activation.special[iEvent] == Active || activation.special[iEvent] == Inactive) {
+            setVoiceSpecialState((SpecialEvent)iEvent, activation.special[iEvent] == Active);
+        }
     }
 }
 
@@ -520,33 +852,4 @@ void VoicePack::setCurrentVehicle(Vehicle vehicle)
             std::cout << "[INFO  ] Vehicle unknwon" << std::endl;
         }
     }
-}
-
-
-void VoicePack::loadStatusConfig(
-    const std::filesystem::path& basePath,
-    const nlohmann::json& json,
-    std::array<VoiceLine, 2 * StatusEvent::N_StatusEvents>& voiceStatus)
-{
-    for (auto& st : json.items()) {
-        const std::optional<StatusEvent> status = statusFromString(st.key());
-
-        if (!status || status == StatusEvent::N_StatusEvents) {
-            // This is a nested status probably
-            // std::cout << "[WARN  ] Unknown status event: " << st.key() << "\n";
-            continue;
-        }
-
-        for (auto& statusEntry : st.value().items()) {
-            if (statusEntry.key() == "true") {
-                voiceStatus[2 * status.value() + 1].loadFromJson(basePath, statusEntry.value());
-            }
-            else if (statusEntry.key() == "false") {
-                voiceStatus[2 * status.value() + 0].loadFromJson(basePath, statusEntry.value());
-            }
-            else {
-                std::cout << "[WARN  ] Unknown status key: " << statusEntry.key() << "\n";
-            }
-        }
-    }
-}
+}
\ No newline at end of file
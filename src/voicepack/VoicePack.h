@@ -9,22 +9,50 @@
 #include <json.hpp>
 
 #include "Enum.h"
+#include "JournalEventId.h"
 #include "VoiceLine.h"
+#include "VoicePackJson.h"
+#include "VoiceTriggerTable.h"
+#include "../watchers/JournalEvent.h"
+#include "../watchers/StatusField.h"
 
 class VoicePackManager;
 
+// Activation of the voicelines as set in the config
+struct VoiceActivation {
+    std::array<std::array<VoiceTriggerStatus, 2 * StatusEvent::N_StatusEvents>, N_Vehicles> status;
+    std::vector<VoiceTriggerStatus> journal;
+    std::array<VoiceTriggerStatus, N_SpecialEvents> special;
+};
+
 class VoicePack
 {
 public:
     VoicePack(VoicePackManager& voicepackManager);
 
+    // Unpins the critical clips, the player must outlive the voicepack
+    ~VoicePack();
+
     void loadConfig(const std::filesystem::path& filepath);
 
     void onStatusChanged(StatusEvent event, bool status);
 
-    void setJournalPreviousEvent(const std::string& event, const std::string& journalEntry);
+    // Status.json values the voicepack reacts to, besides the flags
+    static StatusFieldMask getStatusFields();
+    static std::vector<StatusThreshold> getStatusThresholds();
+
+    void onStatusFieldsChanged(const StatusSnapshot& previous, const StatusSnapshot& current, StatusFieldMask changedMask);
+    void onStatusThreshold(const StatusThreshold& threshold, double value);
+
+    // Journal events needed to restore the player state at startup
+    static std::vector<std::vector<std::string>> getPrimingGroups();
+
+    // id: interned name of the event, INVALID_JOURNAL_EVENT if unknown
+    void setJournalPreviousEvent(const JournalEvent& journalEvent, JournalEventId id);
 
-    void onJournalEvent(const std::string& event, const std::string& journalEntry);
+    void onJournalPrimingDone();
+
+    void onJournalEvent(const JournalEvent& journalEvent, JournalEventId id);
 
     void onSpecialEvent(SpecialEvent event);
 
@@ -49,13 +77,22 @@ public:
     }
 
     std::array<std::array<VoiceTriggerStatus, 2 * StatusEvent::N_StatusEvents>, N_Vehicles>& getVoiceStatusActive() { return _voiceStatusActive; }
-    std::map<std::string, VoiceTriggerStatus>& getVoiceJournalActive() { return _voiceJournalActive; }
+    // Indexed by JournalEventId, may be shorter than the number of ids
+    std::vector<VoiceTriggerStatus>& getVoiceJournalActive() { return _voiceJournalActive; }
     std::array<VoiceTriggerStatus, N_SpecialEvents>& getVoiceSpecialActive() { return _voiceSpecialActive; }
 
     void setVoiceStatusState(Vehicle vehicle, StatusEvent event, bool statusState, bool active);
-    void setVoiceJournalState(const std::string& event, bool active);
+    void setVoiceJournalState(JournalEventId event, bool active);
     void setVoiceSpecialState(SpecialEvent event, bool active);
 
+    // Mirrors the activation states in the trigger table, once they were
+    // changed through the get*Active() tables
+    void updateActiveTriggers();
+
+    // Sets the lines of the voicepack active or inactive as in the config,
+    // on the thread using the voicepack
+    void applyActivation(const VoiceActivation& activation);
+
     const std::filesystem::path& getVoicePackPath() const { return _configPath; }
 
 private:
@@ -63,21 +100,26 @@ private:
     void setSRVCargo(uint32_t cargo);
     void setCurrentVehicle(Vehicle vehicle);
 
-    static void loadStatusConfig(
-        const std::filesystem::path& basePath,
-        const nlohmann::json& json,
-        std::array<VoiceLine, 2 * StatusEvent::N_StatusEvents>& voiceStatus
-    );
+    void loadJson(const std::filesystem::path& filepath, VoicePackLines& lines);
+    void loadBundle(const std::filesystem::path& filepath, VoicePackLines& lines);
+
+    // Grows the journal tables up to the id
+    size_t journalIndex(VoicePackLines& lines, JournalEventId id);
+
+    void setDefaultPriorities(VoicePackLines& lines);
+
+    void loadClips(VoicePackLines& lines);
+    void prefetchClips();
+    void unpinClips();
 
     std::filesystem::path _configPath;
     VoicePackManager& _voicePackManager;
 
-    std::array<std::array<VoiceLine, 2 * StatusEvent::N_StatusEvents>, N_Vehicles> _voiceStatus;
-    std::map<std::string, VoiceLine> _voiceJournal;
-    std::array<VoiceLine, N_SpecialEvents> _voiceSpecial;
+    VoiceTriggerTable _triggers;
+    bool _clipsPinned = false;
 
     std::array<std::array<VoiceTriggerStatus, 2 * StatusEvent::N_StatusEvents>, N_Vehicles> _voiceStatusActive;
-    std::map<std::string, VoiceTriggerStatus> _voiceJournalActive;
+    std::vector<VoiceTriggerStatus> _voiceJournalActive;
     std::array<VoiceTriggerStatus, N_SpecialEvents> _voiceSpecialActive;
 
     Vehicle _currVehicle = Vehicle::Ship;
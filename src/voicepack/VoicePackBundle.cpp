@@ -0,0 +1,225 @@
+#include "VoicePackBundle.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+
+VoicePackBundle::~VoicePackBundle()
+{
+    close();
+}
+
+
+#ifdef _WIN32
+void VoicePackBundle::open(const std::filesystem::path& path)
+{
+    close();
+
+    _file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (_file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("VoicePackBundle: Cannot open " + path.string());
+    }
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0) {
+        close();
+        throw std::runtime_error("VoicePackBundle: Cannot read size of " + path.string());
+    }
+
+    _mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (_mapping == NULL) {
+        close();
+        throw std::runtime_error("VoicePackBundle: Cannot map " + path.string());
+    }
+
+    _data = (const uint8_t*)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (!_data) {
+        close();
+        throw std::runtime_error("VoicePackBundle: Cannot map " + path.string());
+    }
+
+    _size = (uint64_t)size.QuadPart;
+    _path = path;
+
+    try {
+        validate();
+    }
+    catch (...) {
+        close();
+        throw;
+    }
+}
+
+
+void VoicePackBundle::close()
+{
+    if (_data) {
+        UnmapViewOfFile(_data);
+        _data = nullptr;
+    }
+
+    if (_mapping != NULL) {
+        CloseHandle(_mapping);
+        _mapping = NULL;
+    }
+
+    if (_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(_file);
+        _file = INVALID_HANDLE_VALUE;
+    }
+
+    _size = 0;
+    _header = nullptr;
+}
+#else
+void VoicePackBundle::open(const std::filesystem::path& path)
+{
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0) {
+        throw std::runtime_error("VoicePackBundle: Cannot open " + path.string());
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("VoicePackBundle: Cannot read size of " + path.string());
+    }
+
+    // The mapping stays valid once the descriptor is closed
+    void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("VoicePackBundle: Cannot map " + path.string());
+    }
+
+    _data = (const uint8_t*)data;
+    _size = (uint64_t)st.st_size;
+    _path = path;
+
+    try {
+        validate();
+    }
+    catch (...) {
+        close();
+        throw;
+    }
+}
+
+
+void VoicePackBundle::close()
+{
+    if (_data) {
+        munmap((void*)_data, (size_t)_size);
+        _data = nullptr;
+    }
+
+    _size = 0;
+    _header = nullptr;
+}
+#endif
+
+
+bool VoicePackBundle::isBundle(const std::filesystem::path& path)
+{
+    return path.extension() == BUNDLE_EXTENSION;
+}
+
+
+std::string_view VoicePackBundle::getString(uint32_t offset) const
+{
+    if (offset >= _header->stringsSize) {
+        return {};
+    }
+
+    return std::string_view(_strings + offset);
+}
+
+
+const void* VoicePackBundle::getPCM(const BundleClip& clip) const
+{
+    return _data + _header->pcmOffset + clip.offset;
+}
+
+
+void VoicePackBundle::validate()
+{
+    if (_size < sizeof(BundleHeader)) {
+        throw std::runtime_error("VoicePackBundle: File too small: " + _path.string());
+    }
+
+    _header = (const BundleHeader*)_data;
+
+    if (std::memcmp(_header->magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC)) != 0) {
+        throw std::runtime_error("VoicePackBundle: Not a voicepack bundle: " + _path.string());
+    }
+
+    if (_header->version != BUNDLE_VERSION) {
+        throw std::runtime_error("VoicePackBundle: Unsupported bundle version " + std::to_string(_header->version) + ": " + _path.string());
+    }
+
+    // Every table must lie within the file, nothing is trusted past this point
+    auto checkRange = [this](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        if (offset > _size || count > (_size - offset) / elementSize) {
+            throw std::runtime_error("VoicePackBundle: Truncated bundle: " + _path.string());
+        }
+    };
+
+    if (_header->fileSize != _size) {
+        throw std::runtime_error("VoicePackBundle: Truncated bundle: " + _path.string());
+    }
+
+    checkRange(_header->linesOffset, _header->lineCount, sizeof(BundleLine));
+    checkRange(_header->variantsOffset, _header->variantCount, sizeof(BundleVariant));
+    checkRange(_header->clipsOffset, _header->clipCount, sizeof(BundleClip));
+    checkRange(_header->stringsOffset, _header->stringsSize, 1);
+    checkRange(_header->pcmOffset, 0, 1);
+
+    _lines = (const BundleLine*)(_data + _header->linesOffset);
+    _variants = (const BundleVariant*)(_data + _header->variantsOffset);
+    _clips = (const BundleClip*)(_data + _header->clipsOffset);
+    _strings = (const char*)(_data + _header->stringsOffset);
+
+    if (_header->stringsSize == 0 || _strings[_header->stringsSize - 1] != '\0') {
+        throw std::runtime_error("VoicePackBundle: Invalid string table: " + _path.string());
+    }
+
+    const uint64_t pcmSize = _size - _header->pcmOffset;
+
+    for (uint32_t i = 0; i < _header->lineCount; i++) {
+        const BundleLine& line = _lines[i];
+
+        if (line.firstVariant > _header->variantCount || line.variantCount > _header->variantCount - line.firstVariant) {
+            throw std::runtime_error("VoicePackBundle: Invalid trigger table: " + _path.string());
+        }
+    }
+
+    for (uint32_t i = 0; i < _header->variantCount; i++) {
+        if (_variants[i].clip >= _header->clipCount) {
+            throw std::runtime_error("VoicePackBundle: Invalid variant table: " + _path.string());
+        }
+    }
+
+    for (uint32_t i = 0; i < _header->clipCount; i++) {
+        const BundleClip& clip = _clips[i];
+
+        if (clip.offset > pcmSize || clip.bytes > pcmSize - clip.offset) {
+            throw std::runtime_error("VoicePackBundle: Invalid clip table: " + _path.string());
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+    #include <windows.h>
+#endif
+
+
+// ----------------------------------------------------------------------------
+// Voicepack bundle: the voicepack configuration and its audio, already
+// decoded, in a single file mapped read-only at load.
+//
+// Layout, all offsets from the start of the file:
+//   BundleHeader
+//   BundleLine[lineCount]       trigger table
+//   BundleVariant[variantCount] files of each line, with their probability
+//   BundleClip[clipCount]       PCM location of each file
+//   char[stringsSize]           null terminated names
+//   PCM data                    interleaved frames in the header format
+// ----------------------------------------------------------------------------
+
+constexpr char BUNDLE_MAGIC[4] = { 'E', 'D', 'V', 'P' };
+constexpr uint32_t BUNDLE_VERSION = 2;
+constexpr const char* BUNDLE_EXTENSION = ".edvpack";
+
+// PCM data is aligned on this for SIMD mixing
+constexpr uint64_t BUNDLE_PCM_ALIGNMENT = 64;
+
+struct BundleHeader {
+    char magic[4];
+    uint32_t version;
+
+    // Audio format of all the clips, as SDL_AudioSpec
+    uint32_t audioFormat;
+    uint32_t channels;
+    uint32_t freq;
+
+    uint32_t lineCount;
+    uint32_t variantCount;
+    uint32_t clipCount;
+    uint32_t stringsSize;
+    uint32_t reserved;
+
+    uint64_t linesOffset;
+    uint64_t variantsOffset;
+    uint64_t clipsOffset;
+    uint64_t stringsOffset;
+    uint64_t pcmOffset;
+    uint64_t fileSize;
+};
+
+struct BundleLine {
+    enum Kind : uint32_t {
+        Status,
+        Journal,
+        Special
+    };
+
+    enum Flags : uint32_t {
+        Overlay = 1 << 0,
+        Shuffle = 1 << 1
+    };
+
+    Kind kind;
+    uint32_t nameOffset;    // Status, journal or special event name
+    uint32_t vehicle;       // Status only
+    uint32_t state;         // Status only: 0 false, 1 true
+    uint32_t firstVariant;
+    uint32_t variantCount;
+    int32_t cooldownMs;
+    int32_t ttlMs;          // -1: default of the priority
+    uint32_t priority;      // N_VoicePriorities: default of the event
+    uint32_t flags;
+};
+
+struct BundleVariant {
+    uint32_t clip;
+    uint32_t fileOffset;    // Original file, for display
+    float probability;
+    uint32_t reserved;
+};
+
+// Seek index: PCM is uncompressed, frame n is at offset + n * frame size
+struct BundleClip {
+    uint64_t offset;
+    uint64_t bytes;
+    uint64_t frames;
+};
+
+static_assert(sizeof(BundleHeader) == 88, "Bundle layout changed");
+static_assert(sizeof(BundleLine) == 40, "Bundle layout changed");
+static_assert(sizeof(BundleVariant) == 16, "Bundle layout changed");
+static_assert(sizeof(BundleClip) == 24, "Bundle layout changed");
+
+
+// Read-only memory mapping of a bundle file, tables point into the mapping
+class VoicePackBundle
+{
+public:
+    VoicePackBundle() = default;
+    ~VoicePackBundle();
+
+    VoicePackBundle(const VoicePackBundle&) = delete;
+    VoicePackBundle& operator=(const VoicePackBundle&) = delete;
+
+    // Throws on error or on an invalid bundle
+    void open(const std::filesystem::path& path);
+    void close();
+
+    bool isOpen() const { return _data != nullptr; }
+
+    static bool isBundle(const std::filesystem::path& path);
+
+    const BundleHeader& getHeader() const { return *_header; }
+
+    const BundleLine* getLines() const { return _lines; }
+    const BundleVariant* getVariants() const { return _variants; }
+    const BundleClip* getClips() const { return _clips; }
+
+    std::string_view getString(uint32_t offset) const;
+    const void* getPCM(const BundleClip& clip) const;
+
+    const std::filesystem::path& getPath() const { return _path; }
+
+private:
+    void validate();
+
+private:
+    std::filesystem::path _path;
+
+    const uint8_t* _data = nullptr;
+    uint64_t _size = 0;
+
+#ifdef _WIN32
+    HANDLE _file = INVALID_HANDLE_VALUE;
+    HANDLE _mapping = NULL;
+#endif
+
+    const BundleHeader* _header = nullptr;
+    const BundleLine* _lines = nullptr;
+    const BundleVariant* _variants = nullptr;
+    const BundleClip* _clips = nullptr;
+    const char* _strings = nullptr;
+};
\ No newline at end of file
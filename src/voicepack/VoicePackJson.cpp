@@ -0,0 +1,94 @@
+#include "VoicePackJson.h"
+
+#include <fstream>
+#include <iostream>
+
+
+void VoicePackJson::load(
+    const std::filesystem::path& filepath,
+    std::array<StatusVoiceLines, N_Vehicles>& voiceStatus,
+    std::map<std::string, VoiceLine>& voiceJournal,
+    std::array<VoiceLine, N_SpecialEvents>& voiceSpecial)
+{
+    std::filesystem::path basePath;
+
+    if (filepath.is_absolute()) {
+        basePath = filepath.parent_path();
+    }
+    else {
+        basePath = std::filesystem::current_path() / filepath.parent_path();
+    }
+
+    try {
+        std::ifstream file(filepath);
+        std::string fileContent((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        nlohmann::json json = nlohmann::json::parse(fileContent);
+
+        // Parse status
+        if (json.contains("status")) {
+            // Load common status config
+            for (size_t v = 0; v < N_Vehicles; v++) {
+                loadStatus(basePath, json["status"], voiceStatus[v]);
+            }
+
+            for (size_t v = 0; v < N_Vehicles; v++) {
+                const std::string vehicleName = vehicleToString((Vehicle)v);
+                if (json["status"].contains(vehicleName)) {
+                    loadStatus(basePath, json["status"][vehicleName], voiceStatus[v]);
+                }
+            }
+        }
+
+        // Parse journal
+        if (json.contains("event")) {
+            for (auto& je : json["event"].items()) {
+                voiceJournal[je.key()] = VoiceLine(basePath, je.value());
+            }
+        }
+
+        // Parse journal
+        if (json.contains("special")) {
+            for (auto& je : json["special"].items()) {
+                const std::optional<SpecialEvent> se = specialEventFromString(je.key());
+
+                if (se.has_value()) {
+                    if (*se != SpecialEvent::N_SpecialEvents) {
+                        voiceSpecial[*se].loadFromJson(basePath, je.value());
+                    }
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[ERR] JSON: " << e.what() << "\n";
+    }
+}
+
+
+void VoicePackJson::loadStatus(
+    const std::filesystem::path& basePath,
+    const nlohmann::json& json,
+    StatusVoiceLines& voiceStatus)
+{
+    for (auto& st : json.items()) {
+        const std::optional<StatusEvent> status = statusFromString(st.key());
+
+        if (!status || status == StatusEvent::N_StatusEvents) {
+            // This is a nested status probably
+            // std::cout << "[WARN  ] Unknown status event: " << st.key() << "\n";
+            continue;
+        }
+
+        for (auto& statusEntry : st.value().items()) {
+            if (statusEntry.key() == "true") {
+                voiceStatus[2 * status.value() + 1].loadFromJson(basePath, statusEntry.value());
+            }
+            else if (statusEntry.key() == "false") {
+                voiceStatus[2 * status.value() + 0].loadFromJson(basePath, statusEntry.value());
+            }
+            else {
+                std::cout << "[WARN  ] Unknown status key: " << statusEntry.key() << "\n";
+            }
+        }
+    }
+}
\ No newline at end of file
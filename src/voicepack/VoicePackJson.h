@@ -0,0 +1,33 @@
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <map>
+#include <string>
+
+#include <json.hpp>
+
+#include "Enum.h"
+#include "VoiceLine.h"
+
+
+typedef std::array<VoiceLine, 2 * StatusEvent::N_StatusEvents> StatusVoiceLines;
+
+
+// Voicepack JSON configuration, shared by the voicepack and the bundle packer
+struct VoicePackJson
+{
+    // Lines are added to the given tables, file paths are resolved but not checked
+    static void load(
+        const std::filesystem::path& filepath,
+        std::array<StatusVoiceLines, N_Vehicles>& voiceStatus,
+        std::map<std::string, VoiceLine>& voiceJournal,
+        std::array<VoiceLine, N_SpecialEvents>& voiceSpecial
+    );
+
+    static void loadStatus(
+        const std::filesystem::path& basePath,
+        const nlohmann::json& json,
+        StatusVoiceLines& voiceStatus
+    );
+};
@@ -2,11 +2,13 @@
 
 #include <iostream>
 #include <fstream>
+#include <random>
 
 #include "../util/EliteFileUtil.h"
 
-VoicePackManager::VoicePackManager()
-    : _standardVoicePack(*this)
+VoicePackManager::VoicePackManager(const AudioSinkConfig& sink)
+    : _player(sink)
+    , _standardVoicePack(std::make_unique<VoicePack>(*this))
 #ifdef BUILD_MEDICORP
     , _altaActive(false)
     , _medicVoicePack(*this)
@@ -22,11 +24,17 @@ VoicePackManager::VoicePackManager()
     }
 
     _configVoiceSpecialActive.fill(Undefined);
+    publishActivation();
 }
 
 
 VoicePackManager::~VoicePackManager()
 {
+    // The load uses the player and the bundles
+    if (_voicePackLoad.valid()) {
+        _voicePackLoad.wait();
+    }
+
     try {
         saveConfig();
     }
@@ -40,6 +48,20 @@ void VoicePackManager::loadConfig(const char* filepath)
 {
     _configPath = filepath;
 
+    // A voicepack loaded in the background would be stale
+    {
+        std::lock_guard<std::mutex> lock(_voicePackMutex);
+
+        if (_voicePackLoad.valid()) {
+            _voicePackLoad.wait();
+            _voicePackLoad = {};
+        }
+
+        _queuedVoicePackIndex.reset();
+        _pendingVoicePack.reset();
+        _hasPendingVoicePack = false;
+    }
+
     if (!std::filesystem::exists(filepath)) {
         throw std::runtime_error("Cannot find configuration file: " + std::string(filepath));
     }
@@ -73,6 +95,44 @@ void VoicePackManager::loadConfig(const char* filepath)
         setVolume(volume);
     }
 
+    // Mixing of the voices, relative to the player volume
+    if (json.contains("priorityGain")) {
+        for (auto& gain : json["priorityGain"].items()) {
+            const std::optional<VoicePriority> priority = voicePriorityFromString(gain.key());
+
+            if (priority) {
+                _player.setPriorityGain(*priority, gain.value().get<float>());
+            }
+        }
+    }
+
+    if (json.contains("overlayGain")) {
+        _player.setOverlayGain(json["overlayGain"].get<float>());
+    }
+
+    if (json.contains("duckingGain")) {
+        _player.setDuckingGain(json["duckingGain"].get<float>());
+    }
+
+    // Set before loading the voicepacks, prefetching stays within budget
+    if (json.contains("cacheBudgetMB")) {
+        setCacheBudgetMB(json["cacheBudgetMB"].get<size_t>());
+    }
+
+    // Set before loading the voicepacks, they seed their picks with it
+    _configRandomSeed.reset();
+
+    if (json.contains("randomSeed")) {
+        _configRandomSeed = json["randomSeed"].get<uint64_t>();
+        _randomSeed = *_configRandomSeed;
+    }
+    else {
+        std::random_device device;
+        _randomSeed = ((uint64_t)device() << 32) | device();
+    }
+
+    std::cout << "[INFO  ] Voiceline random seed: " << _randomSeed << std::endl;
+
     // Load installed voicepacks
     if (json.contains("voicepacks")) {
         for (auto& vp : json["voicepacks"].items()) {
@@ -130,7 +190,7 @@ void VoicePackManager::loadConfig(const char* filepath)
 
         if (it != _installedVoicePacksAbsolutePath.end()) {
             std::cout << "[INFO  ] Loading default voicepack: " << defaultVP << std::endl;
-            _standardVoicePack.loadConfig(it->second);
+            _standardVoicePack->loadConfig(it->second);
 
             // Set current voicepack index
             const auto& itInstalledVP = std::find(_installedVoicePacksNames.begin(), _installedVoicePacksNames.end(), defaultVP);
@@ -148,7 +208,7 @@ void VoicePackManager::loadConfig(const char* filepath)
             // Try again with the first installed voicepack
             if (!_installedVoicePacksNames.empty()) {
                 std::cout << "[INFO  ] Loading first installed voicepack: " << _installedVoicePacksNames[0] << std::endl;
-                _standardVoicePack.loadConfig(_installedVoicePacksAbsolutePath[_installedVoicePacksNames[0]]);
+                _standardVoicePack->loadConfig(_installedVoicePacksAbsolutePath[_installedVoicePacksNames[0]]);
                 _currentVoicePackIndex = 0;
             }
             else {
@@ -206,12 +266,28 @@ void VoicePackManager::loadConfig(const char* filepath)
         if (jsonActiveVoiceActions.contains("event")) {
             const nlohmann::json jsonEventVoiceActions = jsonActiveVoiceActions["event"];
 
+            // Interned at once, the lookup table is built a single time
+            std::vector<std::string> names;
+
             for (auto& je : jsonEventVoiceActions.items()) {
+                names.push_back(je.key());
+            }
+
+            const std::vector<JournalEventId> ids = _journalIds.internAll(std::vector<std::string_view>(names.begin(), names.end()));
+            size_t iName = 0;
+
+            for (auto& je : jsonEventVoiceActions.items()) {
+                const JournalEventId id = ids[iName++];
+
+                if (id >= _configVoiceJournalActive.size()) {
+                    _configVoiceJournalActive.resize(id + 1, Undefined);
+                }
+
                 if (je.value().get<bool>()) {
-                    _configVoiceJournalActive[je.key()] = Active;
+                    _configVoiceJournalActive[id] = Active;
                 }
                 else {
-                    _configVoiceJournalActive[je.key()] = Inactive;
+                    _configVoiceJournalActive[id] = Inactive;
                 }
             }
         }
@@ -237,11 +313,13 @@ void VoicePackManager::loadConfig(const char* filepath)
     }
 
     // Merge back potentially new actions from the standard voicepack
-    updateVoicePackSettings(_standardVoicePack);
+    updateVoicePackSettings(*_standardVoicePack);
 #ifdef BUILD_MEDICORP
     updateVoicePackSettings(_medicVoicePack);
 #endif
 
+    publishActivation();
+
     assert(_currentVoicePackIndex < _installedVoicePacksNames.size());
 }
 
@@ -257,22 +335,39 @@ void VoicePackManager::saveConfig() const
     // Player volume
     json["playerVolume"] = getVolume();
 
+    // Voice mixing
+    for (size_t p = 0; p < N_VoicePriorities; p++) {
+        json["priorityGain"][voicePriorityToString((VoicePriority)p)] = _player.getPriorityGain((VoicePriority)p);
+    }
+
+    json["overlayGain"] = _player.getOverlayGain();
+    json["duckingGain"] = _player.getDuckingGain();
+
+    // Decoded audio cache
+    json["cacheBudgetMB"] = _cacheBudgetMB;
+
+    if (_configRandomSeed) {
+        json["randomSeed"] = *_configRandomSeed;
+    }
+
     // Installed voicepacks
     for (const auto& vp : _installedVoicePacks) {
         json["voicepacks"][vp.first] = vp.second;
     }
 
-    // Default voicepacks
-    for (const auto& vp : _installedVoicePacksAbsolutePath) {
-        if (vp.second == _standardVoicePack.getVoicePackPath().string()) {
-            json["defaultVoicePack"] = vp.first;
-        }
+    // Default voicepacks, the standard one may still be waiting for the
+    // dispatch thread to take it
+    if (_currentVoicePackIndex < _installedVoicePacksNames.size()) {
+        json["defaultVoicePack"] = _installedVoicePacksNames[_currentVoicePackIndex];
+    }
+
 #ifdef BUILD_MEDICORP
+    for (const auto& vp : _installedVoicePacksAbsolutePath) {
         if (vp.second == _medicVoicePack.getVoicePackPath().string()) {
             json["medicVoicePack"] = vp.first;
         }
-#endif
     }
+#endif
 
     // Active voice actions
     nlohmann::json jsonActiveVoiceActions;
@@ -307,9 +402,9 @@ void VoicePackManager::saveConfig() const
         }
 
         // Journal events
-        for (const auto& je : _configVoiceJournalActive) {
-            if (je.second != Undefined && je.second != MissingFile) {
-                jsonEventVoiceActions[je.first] = (je.second == Active);
+        for (JournalEventId id = 0; id < _configVoiceJournalActive.size(); id++) {
+            if (_configVoiceJournalActive[id] != Undefined && _configVoiceJournalActive[id] != MissingFile) {
+                jsonEventVoiceActions[_journalIds.getName(id)] = (_configVoiceJournalActive[id] == Active);
             }
         }
 
@@ -342,23 +437,131 @@ void VoicePackManager::loadVoicePackByIndex(size_t index)
     if (index >= _installedVoicePacksNames.size()) {
         throw std::runtime_error("Cannot load voicepack: index out of range");
     }
+
+    const std::string& vpName = _installedVoicePacksNames[index];
+
+    if (_installedVoicePacksAbsolutePath.find(vpName) == _installedVoicePacksAbsolutePath.end()) {
+        throw std::runtime_error("Cannot load voicepack: cannot find voicepack " + vpName);
+    }
+
+    std::lock_guard<std::mutex> lock(_voicePackMutex);
+
+    if (_voicePackLoad.valid()) {
+        // Started once the current load is done
+        _queuedVoicePackIndex = index;
+        return;
+    }
+
     if (index == _currentVoicePackIndex) {
         // Nothing to do
         return;
     }
 
+    startVoicePackLoad(index);
+}
+
+
+void VoicePackManager::startVoicePackLoad(size_t index)
+{
     const std::string& vpName = _installedVoicePacksNames[index];
-    const auto& it = _installedVoicePacksAbsolutePath.find(vpName);
+    const std::filesystem::path path = _installedVoicePacksAbsolutePath[vpName];
 
-    if (it == _installedVoicePacksAbsolutePath.end()) {
-        throw std::runtime_error("Cannot load voicepack: cannot find voicepack " + vpName);
+    std::cout << "[INFO  ] Loading voicepack: " << vpName << std::endl;
+
+    // Into a new voicepack the dispatch thread does not see yet
+    _loadingVoicePackIndex = index;
+    _voicePackLoad = std::async(std::launch::async, [this, path]() {
+        std::unique_ptr<VoicePack> voicepack = std::make_unique<VoicePack>(*this);
+        voicepack->loadConfig(path);
+
+        return voicepack;
+    });
+}
+
+
+bool VoicePackManager::pollVoicePackLoad()
+{
+    std::lock_guard<std::mutex> lock(_voicePackMutex);
+
+    if (!_voicePackLoad.valid()) {
+        return false;
     }
 
-    std::cout << "[INFO  ] Loading voicepack: " << vpName << std::endl;
-    _standardVoicePack.loadConfig(it->second);
-    _currentVoicePackIndex = index;
+    if (_voicePackLoad.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return true;
+    }
+
+    std::string error;
+
+    try {
+        std::unique_ptr<VoicePack> voicepack = _voicePackLoad.get();
+
+        // New events of the voicepack are published before it is
+        updateVoicePackSettings(*voicepack);
+        publishActivation();
+        _currentVoicePackIndex = _loadingVoicePackIndex;
 
-    updateVoicePackSettings(_standardVoicePack);
+        // Replaces a published voicepack not taken yet
+        _pendingVoicePack = std::move(voicepack);
+        _hasPendingVoicePack = true;
+
+        std::cout << "[INFO  ] Voicepack ready: " << _installedVoicePacksNames[_currentVoicePackIndex] << std::endl;
+    }
+    catch (const std::exception& e) {
+        error = "Cannot load voicepack: " + std::string(e.what());
+        std::cerr << "[ERR   ] " << error << std::endl;
+    }
+
+    if (_queuedVoicePackIndex) {
+        const size_t index = *_queuedVoicePackIndex;
+        _queuedVoicePackIndex.reset();
+
+        if (index != _currentVoicePackIndex) {
+            startVoicePackLoad(index);
+        }
+    }
+
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+
+    return _voicePackLoad.valid();
+}
+
+
+void VoicePackManager::syncVoicePacks()
+{
+    if (_hasPendingVoicePack) {
+        // Freed out of the lock
+        std::unique_ptr<VoicePack> previous;
+
+        {
+            std::lock_guard<std::mutex> lock(_voicePackMutex);
+
+            // Game state carries over, as when switching to ALTA
+            _pendingVoicePack->transferSettings(*_standardVoicePack);
+
+            previous = std::move(_standardVoicePack);
+            _standardVoicePack = std::move(_pendingVoicePack);
+            _hasPendingVoicePack = false;
+        }
+
+        // Toggled since it was loaded
+        _appliedActivation.reset();
+
+        std::cout << "[INFO  ] Switched to voicepack: " << _standardVoicePack->getVoicePackPath() << std::endl;
+    }
+
+    // The GUI only changes the config, the voicepacks in use are updated here
+    const std::shared_ptr<const VoiceActivation> activation = std::atomic_load(&_activation);
+
+    if (activation != _appliedActivation) {
+        _standardVoicePack->applyActivation(*activation);
+#ifdef BUILD_MEDICORP
+        _medicVoicePack.applyActivation(*activation);
+#endif
+        _appliedActivation = activation;
+    }
 }
 
 
@@ -387,32 +590,101 @@ size_t VoicePackManager::addVoicePack(const std::string& name, const std::filesy
 }
 
 
-void VoicePackManager::onStatusChanged(StatusEvent event, bool status)
+void VoicePackManager::onStatusChanged(StatusFlags flags, StatusFlags changedMask, const LatencyTrace& trace)
 {
+    syncVoicePacks();
+
+    _trace = trace;
+
     // Ignore status change in shutdown state
     if (_isShutdownState) {
         return;
     }
 
 #ifdef BUILD_MEDICORP
-    if (_altaActive) {
-        _medicVoicePack.onStatusChanged(event, status);
+    VoicePack& voicepack = _altaActive ? _medicVoicePack : *_standardVoicePack;
+#else
+    VoicePack& voicepack = *_standardVoicePack;
+#endif
+
+    while (changedMask) {
+        const StatusEvent event = StatusEventUtil::popLowest(changedMask);
+        voicepack.onStatusChanged(event, StatusEventUtil::isSet(flags, event));
     }
-    else {
-        _standardVoicePack.onStatusChanged(event, status);
+}
+
+
+StatusFieldMask VoicePackManager::getStatusFields() const
+{
+    return VoicePack::getStatusFields();
+}
+
+
+std::vector<StatusThreshold> VoicePackManager::getStatusThresholds() const
+{
+    return VoicePack::getStatusThresholds();
+}
+
+
+void VoicePackManager::onStatusFieldsChanged(const StatusSnapshot& previous, const StatusSnapshot& current, StatusFieldMask changedMask)
+{
+    syncVoicePacks();
+
+    if (_isShutdownState) {
+        return;
+    }
+
+#ifdef BUILD_MEDICORP
+    VoicePack& voicepack = _altaActive ? _medicVoicePack : *_standardVoicePack;
+#else
+    VoicePack& voicepack = *_standardVoicePack;
+#endif
+
+    voicepack.onStatusFieldsChanged(previous, current, changedMask);
+}
+
+
+void VoicePackManager::onStatusThreshold(const StatusThreshold& threshold, double value)
+{
+    syncVoicePacks();
+
+    if (_isShutdownState) {
+        return;
     }
+
+#ifdef BUILD_MEDICORP
+    VoicePack& voicepack = _altaActive ? _medicVoicePack : *_standardVoicePack;
 #else
-    _standardVoicePack.onStatusChanged(event, status);
+    VoicePack& voicepack = *_standardVoicePack;
+#endif
+
+    voicepack.onStatusThreshold(threshold, value);
+}
+
+
+std::vector<std::vector<std::string>> VoicePackManager::getPrimingGroups() const
+{
+    std::vector<std::vector<std::string>> groups = VoicePack::getPrimingGroups();
+
+#ifdef BUILD_MEDICORP
+    const std::vector<std::vector<std::string>> medicGroups = MedicCompliant::getPrimingGroups();
+    groups.insert(groups.end(), medicGroups.begin(), medicGroups.end());
 #endif
+
+    return groups;
 }
 
 
-void VoicePackManager::setJournalPreviousEvent(const std::string& event, const std::string& journalEntry)
+void VoicePackManager::setJournalPreviousEvent(const JournalEvent& journalEvent)
 {
+    const JournalEventId id = _journalIds.find(journalEvent.getEvent());
+
+    syncVoicePacks();
+
     _isPriming = true;
 
 #ifdef BUILD_MEDICORP
-    _medicCompliant.update(event, journalEntry);
+    _medicCompliant.update(journalEvent);
     const bool compliant = _medicCompliant.isCompliant();
 
     // Check change of status
@@ -420,44 +692,69 @@ void VoicePackManager::setJournalPreviousEvent(const std::string& event, const s
         if (!_altaActive) {
             // We are activating ALTA
             std::cout << "[INFO  ] ALTA voicepack activated." << std::endl;
-            _medicVoicePack.transferSettings(_standardVoicePack);
+            _medicVoicePack.transferSettings(*_standardVoicePack);
         }
         else {
             // We are deactivating ALTA
             std::cout << "[INFO  ] Standard voicepack activated." << std::endl;
-            _standardVoicePack.transferSettings(_medicVoicePack);
+            _standardVoicePack->transferSettings(_medicVoicePack);
         }
 
         _altaActive = compliant;
     }
 
     if (_altaActive) {
-        _medicVoicePack.setJournalPreviousEvent(event, journalEntry);
+        _medicVoicePack.setJournalPreviousEvent(journalEvent, id);
     }
     else {
-        _standardVoicePack.setJournalPreviousEvent(event, journalEntry);
+        _standardVoicePack->setJournalPreviousEvent(journalEvent, id);
     }
 #else
-    _standardVoicePack.setJournalPreviousEvent(event, journalEntry);
+    _standardVoicePack->setJournalPreviousEvent(journalEvent, id);
 #endif
 
     _isPriming = false;
 }
 
 
-void VoicePackManager::onJournalEvent(const std::string& event, const std::string& journalEntry)
+void VoicePackManager::onJournalPrimingDone()
 {
-    if (event == "Shutdown") {
+    syncVoicePacks();
+
+#ifdef BUILD_MEDICORP
+    if (_altaActive) {
+        _medicVoicePack.onJournalPrimingDone();
+    }
+    else {
+        _standardVoicePack->onJournalPrimingDone();
+    }
+#else
+    _standardVoicePack->onJournalPrimingDone();
+#endif
+}
+
+
+void VoicePackManager::onJournalEvent(const JournalEvent& journalEvent)
+{
+    // Interned once, the voicepacks dispatch on the id
+    const JournalEventId id = _journalIds.find(journalEvent.getEvent());
+
+    syncVoicePacks();
+
+    // Special events triggered by this entry share its trace
+    _trace = journalEvent.getTrace();
+
+    if (id == Journal_Shutdown) {
         _isShutdownState = true;
         std::cout << "[INFO  ] Entering shutdown state" << std::endl;
     }
-    else if (event == "LoadGame") {
+    else if (id == Journal_LoadGame) {
         _isShutdownState = false;
         std::cout << "[INFO  ] Exiting shutdown state" << std::endl;
     }
 
 #ifdef BUILD_MEDICORP
-    _medicCompliant.update(event, journalEntry);
+    _medicCompliant.update(journalEvent);
     const bool compliant = _medicCompliant.isCompliant();
 
     // Check change of status
@@ -465,13 +762,13 @@ void VoicePackManager::onJournalEvent(const std::string& event, const std::strin
         if (!_altaActive) {
             // We are activating ALTA
             std::cout << "[INFO  ] ALTA voicepack activated." << std::endl;
-            _medicVoicePack.transferSettings(_standardVoicePack);
+            _medicVoicePack.transferSettings(*_standardVoicePack);
             _medicVoicePack.onSpecialEvent(Activating);
         }
         else {
             // We are deactivating ALTA
             std::cout << "[INFO  ] Standard voicepack activated." << std::endl;
-            _standardVoicePack.transferSettings(_medicVoicePack);
+            _standardVoicePack->transferSettings(_medicVoicePack);
             _medicVoicePack.onSpecialEvent(Deactivating);
         }
 
@@ -479,13 +776,13 @@ void VoicePackManager::onJournalEvent(const std::string& event, const std::strin
     }
 
     if (_altaActive) {
-        _medicVoicePack.onJournalEvent(event, journalEntry);
+        _medicVoicePack.onJournalEvent(journalEvent, id);
     }
     else {
-        _standardVoicePack.onJournalEvent(event, journalEntry);
+        _standardVoicePack->onJournalEvent(journalEvent, id);
     }
 #else
-    _standardVoicePack.onJournalEvent(event, journalEntry);
+    _standardVoicePack->onJournalEvent(journalEvent, id);
 #endif
 }
 
@@ -494,64 +791,82 @@ void VoicePackManager::playStatusVoiceline(
     Vehicle vehicle,
     StatusEvent event,
     bool status,
-    const std::filesystem::path& path)
+    const VoiceRequest& request)
 {
-    if (!path.empty() &&
+    const std::shared_ptr<const VoiceActivation> activation = std::atomic_load(&_activation);
+
+    if (request.clip != INVALID_AUDIO_CLIP &&
         !_isShutdownState &&
         !_isPriming &&
-        _configVoiceStatusActive[vehicle][indexFromStatusEvent(event, status)] == Active) {
-        _player.addTrack(path);
+        activation->status[vehicle][indexFromStatusEvent(event, status)] == Active) {
+        addTrack(request, std::string(statusToString(event)) + (status ? "" : " (off)"));
     }
 }
 
 
 void VoicePackManager::playJournalVoiceline(
-    const std::string& event,
-    const std::filesystem::path& path)
+    JournalEventId event,
+    const VoiceRequest& request)
 {
-    if (!path.empty() &&
+    const std::shared_ptr<const VoiceActivation> activation = std::atomic_load(&_activation);
+
+    if (request.clip != INVALID_AUDIO_CLIP &&
         !_isShutdownState &&
         !_isPriming &&
-        _configVoiceJournalActive[event] == Active) {
-        _player.addTrack(path);
+        event < activation->journal.size() &&
+        activation->journal[event] == Active) {
+        addTrack(request, _journalIds.getName(event));
     }
 }
 
 
 void VoicePackManager::playSpecialVoiceline(
     SpecialEvent event,
-    const std::filesystem::path& path)
+    const VoiceRequest& request)
 {
-    if (!path.empty() &&
+    const std::shared_ptr<const VoiceActivation> activation = std::atomic_load(&_activation);
+
+    if (request.clip != INVALID_AUDIO_CLIP &&
         !_isShutdownState &&
         !_isPriming &&
-        _configVoiceSpecialActive[event] == Active) {
-        _player.addTrack(path);
+        activation->special[event] == Active) {
+        addTrack(request, specialEventToString(event));
     }
 }
 
 
+void VoicePackManager::addTrack(const VoiceRequest& request, const std::string& eventType)
+{
+    VoiceRequest traced = request;
+    traced.trace = _trace;
+    traced.trace.eventType = _player.getLatencyRecorder().getEventType(eventType);
+    traced.trace.stamp(Decided);
+
+    _player.addTrack(traced);
+}
+
+
 void VoicePackManager::setVoiceStatusState(Vehicle vehicle, StatusEvent event, bool statusState, bool active)
 {
     const size_t index = 2 * event + (statusState ? 1 : 0);
 
     _configVoiceStatusActive[vehicle][index] = (active ? Active : Inactive);
 
-    _standardVoicePack.setVoiceStatusState(vehicle, event, statusState, active);
-#ifdef BUILD_MEDICORP
-    _medicVoicePack.setVoiceStatusState(vehicle, event, statusState, active);
-#endif
+    // Applied to the voicepacks by the dispatch thread
+    publishActivation();
 }
 
 
-void VoicePackManager::setVoiceJournalState(const std::string& event, bool active)
+void VoicePackManager::setVoiceJournalState(JournalEventId event, bool active)
 {
+    if (event >= _configVoiceJournalActive.size()) {
+        _configVoiceJournalActive.resize(event + 1, Undefined);
+    }
+
     _configVoiceJournalActive[event] = (active ? Active : Inactive);
 
-    _standardVoicePack.setVoiceJournalState(event, active);
-#ifdef BUILD_MEDICORP
-    _medicVoicePack.setVoiceJournalState(event, active);
-#endif
+    // Applied to the voicepacks by the dispatch thread
+    publishActivation();
 }
 
 
@@ -559,10 +874,30 @@ void VoicePackManager::setVoiceSpecialState(SpecialEvent event, bool active)
 {
     _configVoiceSpecialActive[event] = (active ? Active : Inactive);
 
-    _standardVoicePack.setVoiceSpecialState(event, active);
-#ifdef BUILD_MEDICORP
-    _medicVoicePack.setVoiceSpecialState(event, active);
-#endif
+    // Applied to the voicepacks by the dispatch thread
+    publishActivation();
+}
+
+
+const VoicePackBundle& VoicePackManager::openBundle(const std::filesystem::path& path)
+{
+    auto it = _bundles.find(path);
+
+    if (it == _bundles.end()) {
+        std::unique_ptr<VoicePackBundle> bundle = std::make_unique<VoicePackBundle>();
+        bundle->open(path);
+
+        it = _bundles.emplace(path, std::move(bundle)).first;
+    }
+
+    return *it->second;
+}
+
+
+void VoicePackManager::setCacheBudgetMB(size_t budgetMB)
+{
+    _cacheBudgetMB = budgetMB;
+    _player.setCacheBudget(budgetMB << 20);
 }
 
 
@@ -570,7 +905,7 @@ void VoicePackManager::updateVoicePackSettings(VoicePack& voicepack)
 {
     // 1 - apply to voicepacks
     std::array<std::array<VoiceTriggerStatus, 2 * StatusEvent::N_StatusEvents>, N_Vehicles>& voiceStatusActive = voicepack.getVoiceStatusActive();
-    std::map<std::string, VoiceTriggerStatus>& voiceJournalActive = voicepack.getVoiceJournalActive();
+    std::vector<VoiceTriggerStatus>& voiceJournalActive = voicepack.getVoiceJournalActive();
     std::array<VoiceTriggerStatus, N_SpecialEvents>& voiceSpecialActive = voicepack.getVoiceSpecialActive();
 
     for (uint32_t iVehicle = 0; iVehicle < N_Vehicles; iVehicle++) {
@@ -581,9 +916,13 @@ void VoicePackManager::updateVoicePackSettings(VoicePack& voicepack)
         }
     }
 
-    for (auto& je : _configVoiceJournalActive) {
-        if (je.second != Undefined && je.second != MissingFile) {
-            voiceJournalActive[je.first] = je.second;
+    // Both tables cover all the ids interned so far
+    voiceJournalActive.resize(std::max(voiceJournalActive.size(), _journalIds.size()), Undefined);
+    _configVoiceJournalActive.resize(voiceJournalActive.size(), Undefined);
+
+    for (JournalEventId id = 0; id < _configVoiceJournalActive.size(); id++) {
+        if (_configVoiceJournalActive[id] != Undefined && _configVoiceJournalActive[id] != MissingFile) {
+            voiceJournalActive[id] = _configVoiceJournalActive[id];
         }
     }
 
@@ -602,9 +941,9 @@ void VoicePackManager::updateVoicePackSettings(VoicePack& voicepack)
         }
     }
 
-    for (auto& je : voiceJournalActive) {
-        if (_configVoiceJournalActive.find(je.first) == _configVoiceJournalActive.end()) {
-            _configVoiceJournalActive[je.first] = je.second;
+    for (JournalEventId id = 0; id < voiceJournalActive.size(); id++) {
+        if (_configVoiceJournalActive[id] == Undefined) {
+            _configVoiceJournalActive[id] = voiceJournalActive[id];
         }
     }
 
@@ -613,4 +952,17 @@ void VoicePackManager::updateVoicePackSettings(VoicePack& voicepack)
             _configVoiceSpecialActive[iEvent] = voiceSpecialActive[iEvent];
         }
     }
+
+    voicepack.updateActiveTriggers();
+}
+
+
+void VoicePackManager::publishActivation()
+{
+    std::shared_ptr<VoiceActivation> activation = std::make_shared<VoiceActivation>();
+    activation->status = _configVoiceStatusActive;
+    activation->journal = _configVoiceJournalActive;
+    activation->special = _configVoiceSpecialActive;
+
+    std::atomic_store(&_activation, std::shared_ptr<const VoiceActivation>(std::move(activation)));
 }
\ No newline at end of file
@@ -2,7 +2,12 @@
 
 #include "VoicePack.h"
 #include "AudioPlayer.h"
+#include "VoicePackBundle.h"
 #include "Enum.h"
+#include "JournalEventId.h"
+#include "../watchers/JournalEvent.h"
+#include "../watchers/StatusEvent.h"
+#include "../watchers/StatusField.h"
 
 #ifdef BUILD_MEDICORP
 #include "MedicComlpiant.h"
@@ -12,25 +17,43 @@
 #include <string>
 #include <map>
 #include <array>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
 
 
 class VoicePackManager
 {
 public:
-    VoicePackManager();
+    explicit VoicePackManager(const AudioSinkConfig& sink = AudioSinkConfig());
     ~VoicePackManager();
 
     void loadConfig(const char* filepath);
     void saveConfig() const;
 
+    // Loads in the background, the voicepack in use keeps playing until
+    // the new one is ready. Throws if the index or the path is invalid.
     void loadVoicePackByIndex(size_t index);
-    size_t addVoicePack(const std::string& name, const std::filesystem::path& path);
 
-    void onStatusChanged(StatusEvent event, bool status);
-    void setJournalPreviousEvent(const std::string& event, const std::string& journalEntry);
-    void onJournalEvent(const std::string& event, const std::string& journalEntry);
+    // Publishes a finished background load, true while one is in progress.
+    // Called by the GUI each frame, throws if the load failed.
+    bool pollVoicePackLoad();
+
+    size_t addVoicePack(const std::string& name, const std::filesystem::path& path);
 
-    VoicePack& getStandardVoicePack() { return _standardVoicePack; }
+    void onStatusChanged(StatusFlags flags, StatusFlags changedMask, const LatencyTrace& trace);
+    StatusFieldMask getStatusFields() const;
+    std::vector<StatusThreshold> getStatusThresholds() const;
+    void onStatusFieldsChanged(const StatusSnapshot& previous, const StatusSnapshot& current, StatusFieldMask changedMask);
+    void onStatusThreshold(const StatusThreshold& threshold, double value);
+    std::vector<std::vector<std::string>> getPrimingGroups() const;
+    void setJournalPreviousEvent(const JournalEvent& journalEvent);
+    void onJournalPrimingDone();
+    void onJournalEvent(const JournalEvent& journalEvent);
+
+    VoicePack& getStandardVoicePack() { return *_standardVoicePack; }
 #ifdef BUILD_MEDICORP
     VoicePack& getMedicVoicePack() { return _medicVoicePack; }
     bool isAltaCompliant() const { return _medicCompliant.isCompliant(); }
@@ -40,16 +63,27 @@ public:
         return 2 * event + (status ? 1 : 0);
     }
 
-    void playStatusVoiceline(Vehicle vehicle, StatusEvent event, bool status, const std::filesystem::path& path);
-    void playJournalVoiceline(const std::string& event, const std::filesystem::path& path);
-    void playSpecialVoiceline(SpecialEvent event, const std::filesystem::path& path);
+    void playStatusVoiceline(Vehicle vehicle, StatusEvent event, bool status, const VoiceRequest& request);
+    void playJournalVoiceline(JournalEventId event, const VoiceRequest& request);
+    void playSpecialVoiceline(SpecialEvent event, const VoiceRequest& request);
+
+    AudioPlayer& getAudioPlayer() { return _player; }
+
+    // Shared by the voicepacks, their journal tables are indexed by these ids
+    JournalEventIds& getJournalEventIds() { return _journalIds; }
+    const JournalEventIds& getJournalEventIds() const { return _journalIds; }
+
+    // Bundles stay mapped while the player may use their clips
+    const VoicePackBundle& openBundle(const std::filesystem::path& path);
 
+    // Config tables, GUI thread only as are the setters
     const std::array<std::array<VoiceTriggerStatus, 2 * StatusEvent::N_StatusEvents>, N_Vehicles>& getVoiceStatusActive() const { return _configVoiceStatusActive; }
-    const std::map<std::string, VoiceTriggerStatus>& getVoiceJournalActive() const { return _configVoiceJournalActive; }
+    // Indexed by JournalEventId, may be shorter than the number of ids
+    const std::vector<VoiceTriggerStatus>& getVoiceJournalActive() const { return _configVoiceJournalActive; }
     const std::array<VoiceTriggerStatus, N_SpecialEvents>& getVoiceSpecialActive() const { return _configVoiceSpecialActive; }
 
     void setVoiceStatusState(Vehicle vehicle, StatusEvent event, bool statusState, bool active);
-    void setVoiceJournalState(const std::string& event, bool active);
+    void setVoiceJournalState(JournalEventId event, bool active);
     void setVoiceSpecialState(SpecialEvent event, bool active);
 
     const std::vector<std::string>& getInstalledVoicePacks() const { return _installedVoicePacksNames; }
@@ -58,12 +92,42 @@ public:
     void setVolume(float volume) { _player.setVolume(volume); }
     float getVolume() const { return _player.getVolume(); }
 
+    void setCacheBudgetMB(size_t budgetMB);
+    size_t getCacheBudgetMB() const { return _cacheBudgetMB; }
+
+    // Seed of the voiceline picks, from the config to replay a session
+    uint64_t getRandomSeed() const { return _randomSeed; }
+
 private:
     void updateVoicePackSettings(VoicePack& voicepack);
 
+    // Makes the config tables visible to the dispatch thread
+    void publishActivation();
+
+    // Under _voicePackMutex
+    void startVoicePackLoad(size_t index);
+
+    // Dispatch thread: takes the published voicepack in use, if any, and
+    // applies the activation changes made since the last call
+    void syncVoicePacks();
+
+    // Tags the request with the trace of the event being handled
+    void addTrack(const VoiceRequest& request, const std::string& eventType);
+
     std::filesystem::path _configPath;
 
-    VoicePack _standardVoicePack;
+    // Before the voicepacks, they intern their events at load
+    JournalEventIds _journalIds;
+
+    // Destroyed after the player
+    std::map<std::filesystem::path, std::unique_ptr<VoicePackBundle>> _bundles;
+
+    // Destroyed after the voicepacks, they unpin their clips
+    AudioPlayer _player;
+    size_t _cacheBudgetMB = 128;
+
+    // Only replaced by the dispatch thread
+    std::unique_ptr<VoicePack> _standardVoicePack;
 
     // MediCorp specific ALTA voicepack
 #ifdef BUILD_MEDICORP
@@ -81,15 +145,38 @@ private:
     std::vector<std::string> _installedVoicePacksNames;
     size_t _currentVoicePackIndex = 0;
 
-    // As determined by the config file
+    // As determined by the config file. GUI thread only, the dispatch
+    // thread reads the published copy.
     std::array<std::array<VoiceTriggerStatus, 2 * StatusEvent::N_StatusEvents>, N_Vehicles> _configVoiceStatusActive;
-    std::map<std::string, VoiceTriggerStatus> _configVoiceJournalActive;
+    std::vector<VoiceTriggerStatus> _configVoiceJournalActive;
     std::array<VoiceTriggerStatus, N_SpecialEvents> _configVoiceSpecialActive;
 
-    AudioPlayer _player;
+    // Immutable copy of the config tables, swapped atomically on each change
+    std::shared_ptr<const VoiceActivation> _activation;
+
+    // Dispatch thread only, last copy applied to the voicepacks in use
+    std::shared_ptr<const VoiceActivation> _appliedActivation;
+
+    // Only saved when set in the config
+    std::optional<uint64_t> _configRandomSeed;
+    uint64_t _randomSeed = 0;
+
+    // Latency trace of the event being handled
+    LatencyTrace _trace;
 
     bool _isShutdownState = false;
     bool _isPriming = false;
+
+    // Background loading of the standard voicepack: one load at a time,
+    // the last request made meanwhile waits in _queuedVoicePackIndex.
+    // A loaded voicepack is published in _pendingVoicePack, the dispatch
+    // thread only checks _hasPendingVoicePack until there is one.
+    std::mutex _voicePackMutex;
+    std::future<std::unique_ptr<VoicePack>> _voicePackLoad;
+    size_t _loadingVoicePackIndex = 0;
+    std::optional<size_t> _queuedVoicePackIndex;
+    std::unique_ptr<VoicePack> _pendingVoicePack;
+    std::atomic<bool> _hasPendingVoicePack{ false };
 };
 
 
@@ -0,0 +1,121 @@
+#include "VoiceScheduler.h"
+
+
+VoiceScheduler::VoiceScheduler(size_t capacity)
+    : _capacity(capacity)
+{
+}
+
+
+bool VoiceScheduler::push(const VoiceRequest& request, std::vector<VoiceRequest>& discarded)
+{
+    // Same line already waiting, the new one adds nothing
+    if (_waiting.count(request.clip) > 0) {
+        _stats[request.priority].dropped++;
+        discarded.push_back(request);
+        return false;
+    }
+
+    if (_size >= _capacity) {
+        // Make room by dropping the oldest line of the lowest priority,
+        // unless the new line is itself the least important
+        size_t lowest = 0;
+
+        while (_queues[lowest].empty()) {
+            lowest++;
+        }
+
+        if (lowest > (size_t)request.priority) {
+            _stats[request.priority].dropped++;
+            discarded.push_back(request);
+            return false;
+        }
+
+        _stats[lowest].dropped++;
+        discarded.push_back(_queues[lowest].front());
+        _waiting.erase(_queues[lowest].front().clip);
+        _queues[lowest].pop_front();
+        _size--;
+    }
+
+    _queues[request.priority].push_back(request);
+    _waiting.insert(request.clip);
+    _size++;
+
+    return true;
+}
+
+
+std::optional<VoiceRequest> VoiceScheduler::pop(std::chrono::steady_clock::time_point now, std::vector<VoiceRequest>& discarded)
+{
+    for (size_t p = N_VoicePriorities; p-- > 0; ) {
+        std::deque<VoiceRequest>& queue = _queues[p];
+
+        while (!queue.empty()) {
+            const VoiceRequest request = queue.front();
+            queue.pop_front();
+            _waiting.erase(request.clip);
+            _size--;
+
+            const double waitMs = std::chrono::duration<double, std::milli>(now - request.queuedAt).count();
+
+            if (request.ttlMs > 0 && waitMs > (double)request.ttlMs) {
+                _stats[p].expired++;
+                discarded.push_back(request);
+                continue;
+            }
+
+            VoicePriorityStats& stats = _stats[p];
+            stats.played++;
+            stats.totalWaitMs += waitMs;
+
+            if (waitMs > stats.maxWaitMs) {
+                stats.maxWaitMs = waitMs;
+            }
+
+            return request;
+        }
+    }
+
+    return std::nullopt;
+}
+
+
+std::optional<VoicePriority> VoiceScheduler::topPriority() const
+{
+    for (size_t p = N_VoicePriorities; p-- > 0; ) {
+        if (!_queues[p].empty()) {
+            return (VoicePriority)p;
+        }
+    }
+
+    return std::nullopt;
+}
+
+
+void VoiceScheduler::recordPreempted(VoicePriority priority)
+{
+    _stats[priority].preempted++;
+}
+
+
+void VoiceScheduler::recordImmediate(VoicePriority priority)
+{
+    _stats[priority].played++;
+}
+
+
+void VoiceScheduler::recordDropped(VoicePriority priority)
+{
+    _stats[priority].dropped++;
+}
+
+
+VoiceSchedulerStats VoiceScheduler::getStats() const
+{
+    VoiceSchedulerStats stats;
+    stats.priorities = _stats;
+    stats.depth = _size;
+
+    return stats;
+}
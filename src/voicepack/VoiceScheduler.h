@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+#include "AudioClip.h"
+#include "Enum.h"
+#include "../util/LatencyTrace.h"
+
+
+// Time a line may wait in the queue before it is dropped, per priority.
+// 0: never expires, critical lines preempt the current one instead.
+constexpr std::array<uint32_t, N_VoicePriorities> DEFAULT_VOICE_TTL_MS = {
+    3000,   // Low
+    5000,   // Normal
+    8000,   // High
+    0       // Critical
+};
+
+// Fade out of a line interrupted by a critical one
+constexpr uint32_t VOICE_PREEMPT_FADE_MS = 150;
+
+// Voices mixed at once: speech, a critical line over it, and overlays
+constexpr size_t VOICE_TRACK_COUNT = 4;
+
+// Gain of the other voices while a critical line plays
+constexpr float DEFAULT_DUCKING_GAIN = 0.3f;
+
+
+struct VoiceRequest {
+    AudioClipId clip = INVALID_AUDIO_CLIP;
+    VoicePriority priority = Normal;
+    uint32_t ttlMs = 0;     // 0: never expires
+    bool overlay = false;   // Short tone layered over speech, never queued
+    std::chrono::steady_clock::time_point queuedAt;
+    LatencyTrace trace;     // From the game event to the playback
+};
+
+
+struct VoicePriorityStats {
+    uint64_t played = 0;
+    uint64_t expired = 0;       // Waited longer than their TTL
+    uint64_t dropped = 0;       // Duplicate, or queue full
+    uint64_t preempted = 0;     // Interrupted by a critical line
+    double totalWaitMs = 0.;
+    double maxWaitMs = 0.;
+
+    double meanWaitMs() const { return played ? totalWaitMs / (double)played : 0.; }
+};
+
+
+struct VoiceSchedulerStats {
+    std::array<VoicePriorityStats, N_VoicePriorities> priorities;
+    size_t depth = 0;
+    uint64_t ingressDropped = 0;    // Player queue full
+};
+
+
+// Lines waiting to be played: highest priority first, oldest first within a
+// priority. Not thread safe, the player guards it.
+class VoiceScheduler
+{
+public:
+    explicit VoiceScheduler(size_t capacity = 8);
+
+    // Returns false if the line is rejected. Rejected and dropped lines are
+    // appended to discarded so the caller can release them.
+    bool push(const VoiceRequest& request, std::vector<VoiceRequest>& discarded);
+
+    // Next line to play, lines past their TTL are appended to discarded
+    std::optional<VoiceRequest> pop(std::chrono::steady_clock::time_point now, std::vector<VoiceRequest>& discarded);
+
+    // Highest waiting priority
+    std::optional<VoicePriority> topPriority() const;
+
+    void recordPreempted(VoicePriority priority);
+
+    // Overlays bypass the queue
+    void recordImmediate(VoicePriority priority);
+    void recordDropped(VoicePriority priority);
+
+    bool empty() const { return _size == 0; }
+    size_t size() const { return _size; }
+
+    VoiceSchedulerStats getStats() const;
+
+private:
+    std::array<std::deque<VoiceRequest>, N_VoicePriorities> _queues;
+    std::array<VoicePriorityStats, N_VoicePriorities> _stats;
+
+    // Clips waiting, for duplicate detection
+    std::unordered_set<AudioClipId> _waiting;
+
+    const size_t _capacity;
+    size_t _size = 0;
+};
\ No newline at end of file
@@ -0,0 +1,290 @@
+#include "VoiceTriggerTable.h"
+
+#include <algorithm>
+
+#include "AudioPlayer.h"
+
+
+void VoiceTriggerTable::build(const VoicePackLines& lines, uint64_t seed)
+{
+    clear();
+    _random.seed(seed);
+
+    const size_t nTriggers = FIRST_JOURNAL_TRIGGER + lines.journal.size();
+    size_t nVariants = 0;
+
+    auto forEachLine = [&lines](auto&& fn) {
+        for (const StatusVoiceLines& voiceStatus : lines.status) {
+            for (const VoiceLine& voiceline : voiceStatus) {
+                fn(voiceline);
+            }
+        }
+
+        for (const VoiceLine& voiceline : lines.special) {
+            fn(voiceline);
+        }
+
+        for (const VoiceLine& voiceline : lines.journal) {
+            fn(voiceline);
+        }
+    };
+
+    forEachLine([&nVariants](const VoiceLine& voiceline) { nVariants += voiceline.getClips().size(); });
+
+    // Sized once, in trigger order
+    _firstVariant.reserve(nTriggers);
+    _variantCount.reserve(nTriggers);
+    _priority.reserve(nTriggers);
+    _ttlMs.reserve(nTriggers);
+    _cooldownMs.reserve(nTriggers);
+    _bagPosition.reserve(nTriggers);
+    _activeBits.assign((nTriggers + 63) / 64, 0);
+    _overlayBits.assign((nTriggers + 63) / 64, 0);
+    _shuffleBits.assign((nTriggers + 63) / 64, 0);
+
+    _clips.reserve(nVariants);
+    _aliasProbability.resize(nVariants);
+    _alias.resize(nVariants);
+    _bag.reserve(nVariants);
+
+    forEachLine([this](const VoiceLine& voiceline) {
+        const TriggerId trigger = (TriggerId)_firstVariant.size();
+        const std::vector<AudioClipId>& clips = voiceline.getClips();
+        const std::vector<float>& probabilities = voiceline.getProbabilities();
+        const VoicePriority priority = voiceline.getPriority().value_or(voiceline.getDefaultPriority());
+
+        _firstVariant.push_back((uint32_t)_clips.size());
+        _variantCount.push_back((uint16_t)std::min<size_t>(clips.size(), UINT16_MAX - 1));
+        _priority.push_back((uint8_t)priority);
+        _ttlMs.push_back((voiceline.getTtlMs() >= 0) ? (uint32_t)voiceline.getTtlMs() : DEFAULT_VOICE_TTL_MS[priority]);
+        _cooldownMs.push_back((uint32_t)voiceline.getCooldownMs());
+
+        if (voiceline.isOverlay()) {
+            _overlayBits[trigger / 64] |= (uint64_t)1 << (trigger % 64);
+        }
+
+        if (voiceline.isShuffle()) {
+            _shuffleBits[trigger / 64] |= (uint64_t)1 << (trigger % 64);
+        }
+
+        for (uint16_t i = 0; i < _variantCount.back(); i++) {
+            _clips.push_back(clips[i]);
+            _bag.push_back(i);
+        }
+
+        // The first draw shuffles the bag
+        _bagPosition.push_back(UINT16_MAX);
+
+        buildAlias(_firstVariant.back(), _variantCount.back(), probabilities);
+    });
+
+    // All cooled down
+    _epoch = Clock::now();
+    _playedAtMs.resize(nTriggers);
+
+    for (size_t i = 0; i < nTriggers; i++) {
+        _playedAtMs[i] = 0u - _cooldownMs[i];
+    }
+}
+
+
+void VoiceTriggerTable::clear()
+{
+    _firstVariant.clear();
+    _variantCount.clear();
+    _priority.clear();
+    _ttlMs.clear();
+    _cooldownMs.clear();
+    _playedAtMs.clear();
+    _bagPosition.clear();
+    _activeBits.clear();
+    _overlayBits.clear();
+    _shuffleBits.clear();
+    _clips.clear();
+    _aliasProbability.clear();
+    _alias.clear();
+    _bag.clear();
+}
+
+
+void VoiceTriggerTable::buildAlias(uint32_t first, uint32_t count, const std::vector<float>& probabilities)
+{
+    if (count == 0) {
+        return;
+    }
+
+    // Vose: probabilities scaled to an average of 1, each variant under 1 is
+    // topped up by one above 1 which becomes its alias
+    float sum = 0.f;
+
+    for (uint32_t i = 0; i < count; i++) {
+        sum += (i < probabilities.size()) ? probabilities[i] : 1.f;
+    }
+
+    std::vector<float> scaled(count);
+    std::vector<uint16_t> small;
+    std::vector<uint16_t> large;
+
+    for (uint16_t i = 0; i < count; i++) {
+        const float p = (i < probabilities.size()) ? probabilities[i] : 1.f;
+        scaled[i] = p * (float)count / sum;
+
+        if (scaled[i] < 1.f) {
+            small.push_back(i);
+        }
+        else {
+            large.push_back(i);
+        }
+    }
+
+    while (!small.empty() && !large.empty()) {
+        const uint16_t less = small.back();
+        const uint16_t more = large.back();
+        small.pop_back();
+
+        _aliasProbability[first + less] = scaled[less];
+        _alias[first + less] = more;
+
+        scaled[more] -= 1.f - scaled[less];
+
+        if (scaled[more] < 1.f) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+
+    // Left over from rounding, always themselves
+    for (uint16_t i : large) {
+        _aliasProbability[first + i] = 1.f;
+        _alias[first + i] = i;
+    }
+
+    for (uint16_t i : small) {
+        _aliasProbability[first + i] = 1.f;
+        _alias[first + i] = i;
+    }
+}
+
+
+void VoiceTriggerTable::setActive(TriggerId trigger, bool active)
+{
+    if (trigger >= size()) {
+        return;
+    }
+
+    const uint64_t bit = (uint64_t)1 << (trigger % 64);
+
+    if (active) {
+        _activeBits[trigger / 64] |= bit;
+    }
+    else {
+        _activeBits[trigger / 64] &= ~bit;
+    }
+}
+
+
+uint32_t VoiceTriggerTable::toMs(Clock::time_point time) const
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(time - _epoch).count();
+}
+
+
+std::optional<VoiceRequest> VoiceTriggerTable::trigger(TriggerId trigger)
+{
+    if (!isActive(trigger) || _variantCount[trigger] == 0) {
+        return std::nullopt;
+    }
+
+    // One clock read for the cooldown and the request
+    const Clock::time_point now = Clock::now();
+    const uint32_t nowMs = toMs(now);
+
+    if (nowMs - _playedAtMs[trigger] < _cooldownMs[trigger]) {
+        return std::nullopt;
+    }
+
+    _playedAtMs[trigger] = nowMs;
+
+    VoiceRequest request;
+    request.priority = (VoicePriority)_priority[trigger];
+    request.ttlMs = _ttlMs[trigger];
+    request.queuedAt = now;
+    request.overlay = (_overlayBits[trigger / 64] >> (trigger % 64)) & 1;
+
+    request.clip = _clips[_firstVariant[trigger] + pickVariant(trigger)];
+
+    return request;
+}
+
+
+uint32_t VoiceTriggerTable::pickVariant(TriggerId trigger)
+{
+    const uint32_t count = _variantCount[trigger];
+
+    if (count == 1) {
+        return 0;
+    }
+
+    if ((_shuffleBits[trigger / 64] >> (trigger % 64)) & 1) {
+        return drawFromBag(trigger);
+    }
+
+    const uint32_t first = _firstVariant[trigger];
+    const uint32_t column = _random.nextBelow(count);
+
+    return (_random.nextFloat() < _aliasProbability[first + column]) ? column : _alias[first + column];
+}
+
+
+uint32_t VoiceTriggerTable::drawFromBag(TriggerId trigger)
+{
+    const uint32_t first = _firstVariant[trigger];
+    const uint32_t count = _variantCount[trigger];
+    uint16_t* bag = &_bag[first];
+
+    if (_bagPosition[trigger] >= count) {
+        const bool drawn = (_bagPosition[trigger] != UINT16_MAX);
+        const uint16_t last = bag[count - 1];
+
+        // Fisher-Yates
+        for (uint32_t i = count - 1; i > 0; i--) {
+            std::swap(bag[i], bag[_random.nextBelow(i + 1)]);
+        }
+
+        // The new bag does not start with the end of the previous one
+        if (drawn && bag[0] == last) {
+            std::swap(bag[0], bag[1 + _random.nextBelow(count - 1)]);
+        }
+
+        _bagPosition[trigger] = 0;
+    }
+
+    return bag[_bagPosition[trigger]++];
+}
+
+
+void VoiceTriggerTable::prefetchClips(AudioPlayer& player, TriggerId trigger, bool pin) const
+{
+    if (trigger >= size()) {
+        return;
+    }
+
+    for (uint32_t i = _firstVariant[trigger]; i < _firstVariant[trigger] + _variantCount[trigger]; i++) {
+        if (pin) {
+            player.pinClip(_clips[i]);
+        }
+        player.prefetchClip(_clips[i]);
+    }
+}
+
+
+void VoiceTriggerTable::unpinClips(AudioPlayer& player, TriggerId trigger) const
+{
+    if (trigger >= size()) {
+        return;
+    }
+
+    for (uint32_t i = _firstVariant[trigger]; i < _firstVariant[trigger] + _variantCount[trigger]; i++) {
+        player.unpinClip(_clips[i]);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "AudioClip.h"
+#include "Enum.h"
+#include "JournalEventId.h"
+#include "VoiceLine.h"
+#include "VoicePackJson.h"
+#include "VoiceScheduler.h"
+#include "../util/Random.h"
+
+class AudioPlayer;
+
+
+// Voicelines of a voicepack as loaded, before being compiled
+struct VoicePackLines {
+    std::array<StatusVoiceLines, N_Vehicles> status;
+    std::array<VoiceLine, N_SpecialEvents> special;
+    std::vector<VoiceLine> journal;     // Indexed by JournalEventId
+};
+
+
+// ----------------------------------------------------------------------------
+// Voicelines of a voicepack compiled for the trigger path, in flat arrays:
+// one entry per trigger, the variants of all the triggers one after another.
+// Triggers are numbered status first (vehicle, event, state), then special
+// events, then journal events by id.
+// Variants are picked in constant time from alias tables, or from a shuffle
+// bag for the lines asking for it, with the random generator of the table:
+// the same seed and the same events give the same voicelines.
+// Not thread safe: built by the thread loading the voicepack, then used by
+// the dispatch thread only, activation changes included.
+// ----------------------------------------------------------------------------
+class VoiceTriggerTable
+{
+public:
+    typedef uint32_t TriggerId;
+
+    static constexpr TriggerId N_STATUS_TRIGGERS = N_Vehicles * 2 * StatusEvent::N_StatusEvents;
+    static constexpr TriggerId FIRST_JOURNAL_TRIGGER = N_STATUS_TRIGGERS + N_SpecialEvents;
+
+    // statusIndex: 2 * event + state
+    static TriggerId statusTrigger(Vehicle vehicle, size_t statusIndex) { return vehicle * 2 * StatusEvent::N_StatusEvents + (TriggerId)statusIndex; }
+    static TriggerId specialTrigger(SpecialEvent event) { return N_STATUS_TRIGGERS + event; }
+    static TriggerId journalTrigger(JournalEventId event) { return FIRST_JOURNAL_TRIGGER + event; }
+
+    // Replaces the content, all triggers start inactive and cooled down
+    void build(const VoicePackLines& lines, uint64_t seed);
+    void clear();
+
+    size_t size() const { return _firstVariant.size(); }
+
+    // Dispatch thread, see VoicePackManager::syncVoicePacks
+    void setActive(TriggerId trigger, bool active);
+    bool isActive(TriggerId trigger) const { return trigger < size() && ((_activeBits[trigger / 64] >> (trigger % 64)) & 1); }
+
+    // The request of a variant if the trigger is active and cooled down,
+    // the cooldown starts over
+    std::optional<VoiceRequest> trigger(TriggerId trigger);
+
+    // Decodes the variants ahead of use, pinned ones stay in the cache
+    void prefetchClips(AudioPlayer& player, TriggerId trigger, bool pin) const;
+    void unpinClips(AudioPlayer& player, TriggerId trigger) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // Milliseconds since _epoch
+    uint32_t toMs(Clock::time_point time) const;
+
+    // Index in the variants of the trigger
+    uint32_t pickVariant(TriggerId trigger);
+    uint32_t drawFromBag(TriggerId trigger);
+
+    void buildAlias(uint32_t first, uint32_t count, const std::vector<float>& probabilities);
+
+    // Per trigger
+    std::vector<uint32_t> _firstVariant;
+    std::vector<uint16_t> _variantCount;
+    std::vector<uint8_t> _priority;
+    std::vector<uint32_t> _ttlMs;
+    std::vector<uint32_t> _cooldownMs;
+
+    // Milliseconds since _epoch. Compared by difference with the cooldown,
+    // it only matters once every 49 days when the clock wraps.
+    std::vector<uint32_t> _playedAtMs;
+
+    // Next draw in the shuffle bag, a new bag is shuffled when it is empty
+    std::vector<uint16_t> _bagPosition;
+
+    std::vector<uint64_t> _activeBits;
+    std::vector<uint64_t> _overlayBits;
+    std::vector<uint64_t> _shuffleBits;
+
+    // Per variant. Alias method: variant i is picked with the probability
+    // _aliasProbability[i], else its alias is.
+    std::vector<AudioClipId> _clips;
+    std::vector<float> _aliasProbability;
+    std::vector<uint16_t> _alias;
+    std::vector<uint16_t> _bag;
+
+    Random _random;
+
+    Clock::time_point _epoch;
+};
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include "JournalEvent.h"
+
+#include "../util/JsonScanner.h"
+
+
+JournalEvent::JournalEvent(std::string_view line, LatencyTrace::Clock::time_point wakeTime)
+    : _raw(line)
+{
+    // "timestamp" and "event" are the first members of each entry,
+    // the scan stops as soon as both are found
+    JsonScanner scanner(_raw);
+    std::string_view key, rawValue;
+
+    while ((_event.empty() || _timestamp.empty()) && scanner.nextMember(key, rawValue)) {
+        if (key == "event") {
+            _event = JsonScanner::toString(rawValue).value_or(std::string_view());
+        }
+        else if (key == "timestamp") {
+            _timestamp = JsonScanner::toString(rawValue).value_or(std::string_view());
+        }
+    }
+
+    if (wakeTime != LatencyTrace::Clock::time_point()) {
+        _trace.stamp(Wake, wakeTime);
+        _trace.stamp(Parsed);
+    }
+}
+
+
+std::string_view JournalEvent::sniffEvent(std::string_view line)
+{
+    JsonScanner scanner(line);
+    std::string_view key, rawValue;
+
+    while (scanner.nextMember(key, rawValue)) {
+        if (key == "event") {
+            return JsonScanner::toString(rawValue).value_or(std::string_view());
+        }
+    }
+
+    return std::string_view();
+}
+
+
+const nlohmann::json& JournalEvent::getJson() const
+{
+    std::call_once(_jsonParsed, [this]() {
+        _json = nlohmann::json::parse(_raw, nullptr, false);
+    });
+
+    return _json;
+}
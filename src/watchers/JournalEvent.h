@@ -0,0 +1,107 @@
+#pragma once
+
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <json.hpp>
+
+#include "../util/LatencyTrace.h"
+
+
+// A single journal entry, built once per line and shared by all consumers.
+// Immutable once constructed. The event name and timestamp are read directly
+// from the line bytes, the JSON DOM is only built when a consumer needs the
+// other fields.
+// Always owned by a JournalEventPtr: consumers outliving the callback keep it
+// with shared_from_this().
+class JournalEvent : public std::enable_shared_from_this<JournalEvent>
+{
+public:
+    // wakeTime: when the file watcher was notified of the line, if known
+    explicit JournalEvent(std::string_view line, LatencyTrace::Clock::time_point wakeTime = {});
+
+    JournalEvent(const JournalEvent&) = delete;
+    JournalEvent& operator=(const JournalEvent&) = delete;
+
+    // False if the line is not a valid journal entry
+    bool isValid() const { return !_event.empty(); }
+
+    // Views on the raw line, valid as long as the event lives
+    std::string_view getEvent() const { return _event; }
+    std::string_view getTimestamp() const { return _timestamp; }
+    const std::string& getRaw() const { return _raw; }
+
+    // Parsed entry, a discarded value if the line is not valid JSON
+    const nlohmann::json& getJson() const;
+
+    // Field of the entry, nested keys in order. Empty if the line is not
+    // valid JSON, or if the field is missing or of another type.
+    template<typename T>
+    std::optional<T> getField(std::initializer_list<const char*> path) const { return getField<T>(getJson(), path); }
+
+    // Same on any value of an entry
+    template<typename T>
+    static std::optional<T> getField(const nlohmann::json& json, std::initializer_list<const char*> path);
+
+    // Wake and parse times, empty for the entries read at startup
+    const LatencyTrace& getTrace() const { return _trace; }
+
+    // Event name of a raw journal line, empty if not found
+    static std::string_view sniffEvent(std::string_view line);
+
+private:
+    const std::string _raw;
+    std::string_view _event;
+    std::string_view _timestamp;
+    LatencyTrace _trace;
+
+    mutable std::once_flag _jsonParsed;
+    mutable nlohmann::json _json;
+};
+
+typedef std::shared_ptr<const JournalEvent> JournalEventPtr;
+
+
+template<typename T>
+std::optional<T> JournalEvent::getField(const nlohmann::json& json, std::initializer_list<const char*> path)
+{
+    const nlohmann::json* value = &json;
+
+    // A discarded value is not an object either
+    for (const char* key : path) {
+        if (!value->is_object()) {
+            return std::nullopt;
+        }
+
+        const auto it = value->find(key);
+
+        if (it == value->end()) {
+            return std::nullopt;
+        }
+
+        value = &*it;
+    }
+
+    if constexpr (std::is_same_v<T, bool>) {
+        if (!value->is_boolean()) {
+            return std::nullopt;
+        }
+    }
+    else if constexpr (std::is_arithmetic_v<T>) {
+        if (!value->is_number()) {
+            return std::nullopt;
+        }
+    }
+    else {
+        if (!value->is_string()) {
+            return std::nullopt;
+        }
+    }
+
+    return value->get<T>();
+}
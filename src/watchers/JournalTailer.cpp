@@ -0,0 +1,165 @@
+#include "JournalTailer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+
+JournalTailer::JournalTailer()
+    : _buffer(READ_CHUNK_SIZE)
+{
+}
+
+
+bool JournalTailer::open(const std::filesystem::path& path, uint64_t offset)
+{
+    _path = path;
+    _readOffset = offset;
+    _pendingSize = 0;
+
+    return _file.open(path);
+}
+
+
+void JournalTailer::close()
+{
+    _file.close();
+    _path.clear();
+    _readOffset = 0;
+    _pendingSize = 0;
+}
+
+
+void JournalTailer::readLines(const std::function<void(std::string_view)>& onLine)
+{
+    if (!_file.isOpen()) {
+        return;
+    }
+
+    while (true) {
+        // Make room for a full chunk after the pending partial line
+        if (_buffer.size() < _pendingSize + READ_CHUNK_SIZE) {
+            _buffer.resize(_pendingSize + READ_CHUNK_SIZE);
+        }
+
+        const int64_t bytesRead = _file.readAt(_readOffset, _buffer.data() + _pendingSize, READ_CHUNK_SIZE);
+
+        if (bytesRead <= 0) {
+            break;
+        }
+
+        _readOffset += bytesRead;
+
+        const size_t available = _pendingSize + (size_t)bytesRead;
+        size_t lineStart = 0;
+
+        // Only scan the new bytes for line terminators, the pending part has none
+        const char* newline = (const char*)std::memchr(_buffer.data() + _pendingSize, '\n', (size_t)bytesRead);
+
+        while (newline) {
+            const size_t lineEnd = newline - _buffer.data();
+            size_t lineLength = lineEnd - lineStart;
+
+            if (lineLength > 0 && _buffer[lineStart + lineLength - 1] == '\r') {
+                lineLength--;
+            }
+
+            if (lineLength > 0) {
+                onLine(std::string_view(_buffer.data() + lineStart, lineLength));
+            }
+
+            lineStart = lineEnd + 1;
+            newline = (const char*)std::memchr(_buffer.data() + lineStart, '\n', available - lineStart);
+        }
+
+        // Keep the partial trailing line for the next call
+        _pendingSize = available - lineStart;
+
+        if (_pendingSize > 0 && lineStart > 0) {
+            std::memmove(_buffer.data(), _buffer.data() + lineStart, _pendingSize);
+        }
+
+        if ((size_t)bytesRead < READ_CHUNK_SIZE) {
+            break;
+        }
+    }
+}
+
+
+void JournalTailer::readLinesBackward(const std::function<bool(std::string_view)>& onLine)
+{
+    if (!_file.isOpen()) {
+        return;
+    }
+
+    const int64_t fileSize = _file.size();
+
+    if (fileSize <= 0) {
+        return;
+    }
+
+    // Bytes of the line being assembled, when it spans several chunks
+    std::string lineTail;
+
+    // Until the first '\n' is met, bytes belong to a line still being written
+    bool hasCompleteLine = false;
+    uint64_t completeEnd = 0;
+
+    auto emitLine = [&](std::string_view line) {
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
+        return line.empty() || onLine(line);
+    };
+
+    uint64_t chunkOffset = (uint64_t)fileSize;
+    bool stop = false;
+
+    while (chunkOffset > 0 && !stop) {
+        const size_t chunkSize = (size_t)std::min<uint64_t>(READ_CHUNK_SIZE, chunkOffset);
+        chunkOffset -= chunkSize;
+
+        const int64_t bytesRead = _file.readAt(chunkOffset, _buffer.data(), chunkSize);
+
+        if (bytesRead != (int64_t)chunkSize) {
+            break;
+        }
+
+        // Scan the chunk from its end
+        size_t segmentEnd = chunkSize;
+
+        for (size_t i = chunkSize; i-- > 0 && !stop; ) {
+            if (_buffer[i] != '\n') {
+                continue;
+            }
+
+            if (!hasCompleteLine) {
+                hasCompleteLine = true;
+                completeEnd = chunkOffset + i + 1;
+            }
+            else if (lineTail.empty()) {
+                stop = !emitLine(std::string_view(_buffer.data() + i + 1, segmentEnd - i - 1));
+            }
+            else {
+                lineTail.insert(0, _buffer.data() + i + 1, segmentEnd - i - 1);
+                stop = !emitLine(lineTail);
+            }
+
+            lineTail.clear();
+            segmentEnd = i;
+        }
+
+        if (!stop) {
+            lineTail.insert(0, _buffer.data(), segmentEnd);
+        }
+    }
+
+    // First line of the file
+    if (!stop && chunkOffset == 0 && hasCompleteLine && !lineTail.empty()) {
+        emitLine(lineTail);
+    }
+
+    _readOffset = completeEnd;
+    _pendingSize = 0;
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+#include "../util/FileReader.h"
+
+
+// Incremental reader for an append-only journal file.
+// Keeps the file open and a persistent offset: each call to readLines only
+// reads the bytes appended since the previous call. A trailing line without
+// its '\n' is kept in the buffer until the game finishes writing it.
+class JournalTailer
+{
+public:
+    JournalTailer();
+
+    bool open(const std::filesystem::path& path, uint64_t offset = 0);
+    void close();
+
+    bool isOpen() const { return _file.isOpen(); }
+    const std::filesystem::path& getPath() const { return _path; }
+
+    // Offset of the first byte not yet delivered as a complete line
+    uint64_t getOffset() const { return _readOffset - _pendingSize; }
+
+    // Calls onLine for each new complete line (without the line terminator).
+    // The view is only valid during the callback.
+    void readLines(const std::function<void(std::string_view)>& onLine);
+
+    // Walks the complete lines from the end of the file back to the start,
+    // until onLine returns false. Then moves the offset after the last complete
+    // line: subsequent readLines calls only see entries written after the scan.
+    void readLinesBackward(const std::function<bool(std::string_view)>& onLine);
+
+private:
+    static constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+
+    FileReader _file;
+    std::filesystem::path _path;
+
+    uint64_t _readOffset = 0;
+
+    std::vector<char> _buffer;
+    size_t _pendingSize = 0;
+};
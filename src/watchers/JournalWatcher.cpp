@@ -1,29 +1,26 @@
 #include "JournalWatcher.h"
 
+#include <algorithm>
 #include <iostream>
-#include <json.hpp>
+
+#include "../util/EliteFileUtil.h"
 
 
 JournalWatcher::JournalWatcher(const std::filesystem::path& filename)
     : _currJournalPath(filename)
-    , _currJournalFile(filename)
-    , _stopForceUpdate(false)
 {
-    if (!std::filesystem::exists(filename)) {
+    if (!std::filesystem::exists(filename) || !_tailer.open(filename)) {
         throw std::runtime_error("Cannot find journal file: " + filename.string() + ". Did you lanch the game previously?");
     }
 
+    _currJournalKey = EliteFileUtil::getJournalKey(filename).value_or(0);
+
     std::wcout << L"[INFO  ] Monitoring: " << _currJournalPath << std::endl;
 }
 
 
 JournalWatcher::~JournalWatcher()
 {
-    _stopForceUpdate = true;
-    
-    if (_forcedUpdateThread.joinable()) {
-        _forcedUpdateThread.join();
-    }
 }
 
 
@@ -35,52 +32,139 @@ void JournalWatcher::addListener(JournalListener* listener)
 
 void JournalWatcher::start()
 {
-    // Prime the listeners with existing entries
-    std::string line;
+    primeListeners();
+}
 
-    while (std::getline(_currJournalFile, line)) {
-        auto j = nlohmann::json::parse(line);
 
-        for (JournalListener* listener : _listeners) {
-            listener->setJournalPreviousEvent(j["event"], line);
-        }
+void JournalWatcher::update(LatencyTrace::Clock::time_point wakeTime)
+{
+    if (!_tailer.isOpen() && !_tailer.open(_currJournalPath)) {
+        return;
     }
 
-    _forcedUpdateThread = std::thread(&JournalWatcher::forcedUpdate, this);
+    readNewEntries(wakeTime);
 }
 
 
-void JournalWatcher::update(const std::filesystem::path& filename)
+void JournalWatcher::onJournalCreated(const std::filesystem::path& filename, LatencyTrace::Clock::time_point wakeTime)
 {
-    if (filename != _currJournalPath) {
-        // The observed journal changed
-        _currJournalFile.close();
-        _currJournalFile = std::ifstream(filename);
-        _currJournalPath = filename;
+    const std::optional<uint64_t> key = EliteFileUtil::getJournalKey(filename);
+
+    if (!key || *key <= _currJournalKey) {
+        return;
+    }
+
+    // Do not lose the last entries of the previous journal
+    readNewEntries(wakeTime);
+
+    _currJournalPath = filename;
+    _currJournalKey = *key;
 
-        std::wcout << L"[INFO  ] Monitoring: " << _currJournalPath << std::endl;
+    if (!_tailer.open(filename)) {
+        // Retried on next update
+        std::wcerr << L"[ERR   ] Cannot open journal: " << filename << std::endl;
+        return;
     }
 
-    std::string line;
+    std::wcout << L"[INFO  ] Monitoring: " << _currJournalPath << std::endl;
+
+    readNewEntries(wakeTime);
+}
+
+
+void JournalWatcher::primeListeners()
+{
+    // Instead of replaying the whole journal, the listeners are primed with the
+    // latest entry of each priming group, found by scanning the file backward.
+    // Listeners needing a full replay also get all the entries since the last
+    // LoadGame.
+    std::vector<JournalPrimingGroup> groups;
+    bool fullReplay = false;
+
+    for (JournalListener* listener : _listeners) {
+        const std::vector<JournalPrimingGroup> listenerGroups = listener->getPrimingGroups();
+        groups.insert(groups.end(), listenerGroups.begin(), listenerGroups.end());
+
+        fullReplay = fullReplay || listener->needsFullReplay();
+    }
+
+    std::vector<bool> groupFound(groups.size(), false);
+    size_t nGroupsFound = 0;
+
+    struct ReplayedEntry {
+        JournalEventPtr journalEvent;
+        bool isPrimingEntry;
+    };
+
+    std::vector<ReplayedEntry> replayedEntries;
+    size_t nPrimingEntries = 0;
 
-    while (std::getline(_currJournalFile, line)) {
-        auto j = nlohmann::json::parse(line);
+    _tailer.readLinesBackward([&](std::string_view line) {
+        const std::string_view event = JournalEvent::sniffEvent(line);
+        bool isNeeded = false;
 
+        for (size_t i = 0; i < groups.size(); i++) {
+            if (!groupFound[i] && std::find(groups[i].begin(), groups[i].end(), event) != groups[i].end()) {
+                groupFound[i] = true;
+                nGroupsFound++;
+                isNeeded = true;
+            }
+        }
+
+        if (isNeeded || fullReplay) {
+            JournalEventPtr journalEvent = std::make_shared<const JournalEvent>(line);
+
+            if (journalEvent->isValid()) {
+                replayedEntries.push_back({ std::move(journalEvent), isNeeded });
+                nPrimingEntries += isNeeded ? 1 : 0;
+            }
+        }
+
+        // The game dumps the whole player state after loading a game:
+        // older entries are outdated
+        if (event == "LoadGame") {
+            return false;
+        }
+
+        return fullReplay || nGroupsFound < groups.size();
+    });
+
+    // Replay in chronological order
+    for (auto it = replayedEntries.rbegin(); it != replayedEntries.rend(); it++) {
         for (JournalListener* listener : _listeners) {
-            listener->onJournalEvent(j["event"], line);
+            if (it->isPrimingEntry || listener->needsFullReplay()) {
+                listener->setJournalPreviousEvent(*it->journalEvent, it->isPrimingEntry);
+            }
         }
     }
 
-    // Clear EOF flag
-    _currJournalFile.clear();
-}
+    for (JournalListener* listener : _listeners) {
+        listener->onJournalPrimingDone();
+    }
 
+    std::cout << "[INFO  ] Journal primed with " << nPrimingEntries << " entries";
 
-void JournalWatcher::forcedUpdate() {
-    // We need to regularly load the file to avoid miss in the WIN32 monitoring
-    // in case the file was not flushed to the disk.
-    while (!_stopForceUpdate) {
-        std::wifstream file(_currJournalPath, std::ios::in | std::ios::binary);
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (fullReplay) {
+        std::cout << ", " << replayedEntries.size() << " replayed to plugins";
     }
-}
\ No newline at end of file
+
+    std::cout << std::endl;
+}
+
+
+void JournalWatcher::readNewEntries(LatencyTrace::Clock::time_point wakeTime)
+{
+    _tailer.readLines([&](std::string_view line) {
+        // Parsed once, shared by all the listeners
+        const JournalEventPtr journalEvent = std::make_shared<const JournalEvent>(line, wakeTime);
+
+        if (!journalEvent->isValid()) {
+            std::cerr << "[ERR   ] Invalid journal entry: " << line << std::endl;
+            return;
+        }
+
+        for (JournalListener* listener : _listeners) {
+            listener->onJournalEvent(*journalEvent);
+        }
+    });
+}
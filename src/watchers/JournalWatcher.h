@@ -1,18 +1,34 @@
 #pragma once
 
 #include <filesystem>
-#include <fstream>
+#include <string_view>
 #include <vector>
-#include <thread>
-#include <atomic>
 
 #include <PluginInterface.h>
 
+#include "JournalEvent.h"
+#include "JournalTailer.h"
+
+// Journal events of which only the most recent entry is needed to restore
+// a piece of state at startup, e.g. the current vehicle
+typedef std::vector<std::string> JournalPrimingGroup;
+
+
 class JournalListener
 {
 public:
-    virtual void setJournalPreviousEvent(const std::string& event, const std::string& jounralEntry) = 0;
-    virtual void onJournalEvent(const std::string& event, const std::string& jounralEntry) = 0;
+    // Entries replayed through setJournalPreviousEvent at startup
+    virtual std::vector<JournalPrimingGroup> getPrimingGroups() const { return {}; }
+
+    // True to get every entry since the last LoadGame at startup, for the
+    // listeners that cannot declare priming groups (plugins)
+    virtual bool needsFullReplay() const { return false; }
+
+    // isPrimingEntry: latest entry of a priming group, the other entries are
+    // only replayed to the listeners needing a full replay
+    virtual void setJournalPreviousEvent(const JournalEvent& journalEvent, bool isPrimingEntry) = 0;
+    virtual void onJournalPrimingDone() {}
+    virtual void onJournalEvent(const JournalEvent& journalEvent) = 0;
 };
 
 
@@ -26,16 +42,21 @@ public:
 
     void start();
 
-    void update(const std::filesystem::path& filename);
+    // Reads new entries of the current journal.
+    // wakeTime: when the file watcher was woken up, for latency tracing.
+    void update(LatencyTrace::Clock::time_point wakeTime);
+
+    // A journal was created in the profile folder. If newer than the current
+    // one, the current journal is read to its end and the new one is followed.
+    void onJournalCreated(const std::filesystem::path& filename, LatencyTrace::Clock::time_point wakeTime);
 
 private:
-    void forcedUpdate();
+    void primeListeners();
+    void readNewEntries(LatencyTrace::Clock::time_point wakeTime);
 
 private:
     std::filesystem::path _currJournalPath;
-    std::ifstream _currJournalFile;
+    uint64_t _currJournalKey = 0;
+    JournalTailer _tailer;
     std::vector<JournalListener*> _listeners;
-
-    std::atomic<bool> _stopForceUpdate;
-    std::thread _forcedUpdateThread;
 };
\ No newline at end of file
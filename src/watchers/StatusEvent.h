@@ -2,8 +2,23 @@
 
 #include <PluginInterface.h>
 
+#include <array>
+#include <cstdint>
 #include <optional>
-#include <string>
+#include <string_view>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "../util/PerfectHash.hpp"
+
+
+// Flags in the low 32 bits, Flags2 in the high 32 bits
+typedef uint64_t StatusFlags;
+
+static_assert(N_StatusEvents <= 64, "Status events do not fit in StatusFlags");
+static_assert(On_Foot == 32, "Flags2 events must start at bit 32");
 
 
 struct StatusEventUtil {
@@ -18,11 +33,50 @@ struct StatusEventUtil {
     }
 
 
-    static std::optional<StatusEvent> fromString(const std::string& s)
+    static std::optional<StatusEvent> fromString(std::string_view s)
+    {
+        static constexpr std::array<std::string_view, N_StatusEvents> NAMES = {
+    #define GEN_NAME(name) #name,
+            STATUS_EVENTS(GEN_NAME)
+    #undef GEN_NAME
+        };
+
+        static constexpr PerfectHash<StatusEvent, N_StatusEvents> LOOKUP(NAMES);
+        static_assert(LOOKUP.isValid(), "No perfect hash for StatusEvent names");
+
+        return LOOKUP.find(s);
+    }
+
+
+    static constexpr StatusFlags toFlags(uint32_t flags, uint32_t flags2)
+    {
+        return (StatusFlags)flags | ((StatusFlags)flags2 << 32);
+    }
+
+
+    // Bits that map to a known StatusEvent
+    static constexpr StatusFlags knownMask()
+    {
+        return (N_StatusEvents == 64) ? ~(StatusFlags)0 : (((StatusFlags)1 << N_StatusEvents) - 1);
+    }
+
+
+    static bool isSet(StatusFlags flags, StatusEvent ev)
+    {
+        return (flags >> ev) & 1;
+    }
+
+
+    // Removes the lowest set bit from mask and returns its event, mask must not be 0
+    static StatusEvent popLowest(StatusFlags& mask)
     {
-    #define GEN_IF(name) if (s == #name) return name;
-        STATUS_EVENTS(GEN_IF)
-    #undef GEN_IF
-        return std::nullopt;
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, mask);
+#else
+        const int index = __builtin_ctzll(mask);
+#endif
+        mask &= mask - 1;
+        return (StatusEvent)index;
     }
 };
\ No newline at end of file
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "../util/PerfectHash.hpp"
+
+/* https://elite-journal.readthedocs.io/en/latest/Status%20File.html
+Numeric values of Status.json, names are the JSON keys.
+Fuel and Pips are nested: Fuel { FuelMain, FuelReservoir }, Pips [ sys, eng, wep ]
+Pips are in half pips (0 to 8)
+Oxygen and Health are in [0, 1], Temperature in Kelvin, Gravity in G
+*/
+
+#define STATUS_FIELDS(X)            \
+    X(FuelMain)                     \
+    X(FuelReservoir)                \
+    X(Cargo)                        \
+    X(GuiFocus)                     \
+    X(FireGroup)                    \
+    X(PipsSys)                      \
+    X(PipsEng)                      \
+    X(PipsWep)                      \
+    X(Oxygen)                       \
+    X(Health)                       \
+    X(Temperature)                  \
+    X(Gravity)                      \
+    X(Latitude)                     \
+    X(Longitude)                    \
+    X(Altitude)                     \
+    X(Heading)                      \
+    X(PlanetRadius)                 \
+    X(Balance)
+
+enum StatusField {
+#define GEN_ENUM(name) name,
+    STATUS_FIELDS(GEN_ENUM)
+#undef GEN_ENUM
+    N_StatusFields
+};
+
+typedef uint32_t StatusFieldMask;
+
+static_assert(N_StatusFields <= 32, "Status fields do not fit in StatusFieldMask");
+
+
+struct StatusFieldUtil {
+    static const char* toString(StatusField field)
+    {
+        switch (field) {
+    #define GEN_CASE(name) case name: return #name;
+            STATUS_FIELDS(GEN_CASE)
+    #undef GEN_CASE
+        default: return "Unknown";
+        }
+    }
+
+
+    static std::optional<StatusField> fromString(std::string_view s)
+    {
+        static constexpr std::array<std::string_view, N_StatusFields> NAMES = {
+    #define GEN_NAME(name) #name,
+            STATUS_FIELDS(GEN_NAME)
+    #undef GEN_NAME
+        };
+
+        static constexpr PerfectHash<StatusField, N_StatusFields> LOOKUP(NAMES);
+        static_assert(LOOKUP.isValid(), "No perfect hash for StatusField names");
+
+        return LOOKUP.find(s);
+    }
+
+
+    static constexpr StatusFieldMask toMask(StatusField field)
+    {
+        return (StatusFieldMask)1 << field;
+    }
+
+
+    static constexpr StatusFieldMask allFields()
+    {
+        return ((StatusFieldMask)1 << N_StatusFields) - 1;
+    }
+};
+
+
+// Decoded Status.json. Most fields only exist in some contexts
+// (Oxygen on foot, Latitude near a planet...), see present.
+struct StatusSnapshot {
+    std::array<double, N_StatusFields> values = {};
+    StatusFieldMask present = 0;
+
+    bool has(StatusField field) const { return present & StatusFieldUtil::toMask(field); }
+
+    void set(StatusField field, double value)
+    {
+        values[field] = value;
+        present |= StatusFieldUtil::toMask(field);
+    }
+};
+
+
+// Notified once when a field crosses the given value
+struct StatusThreshold {
+    enum Direction {
+        Below,
+        Above
+    };
+
+    StatusField field;
+    Direction direction;
+    double value;
+
+    bool operator==(const StatusThreshold& other) const
+    {
+        return field == other.field && direction == other.direction && value == other.value;
+    }
+
+    bool isReached(const StatusSnapshot& snapshot) const
+    {
+        if (!snapshot.has(field)) {
+            return false;
+        }
+
+        return (direction == Below) ? snapshot.values[field] < value : snapshot.values[field] > value;
+    }
+};
\ No newline at end of file
@@ -1,14 +1,13 @@
 #include "StatusWatcher.h"
 
-#include <fstream>
-#include <json.hpp>
 #include <iostream>
 
+#include "../util/JsonScanner.h"
+
 
 StatusWatcher::StatusWatcher(
     const std::filesystem::path& filename)
     : _statusFile(filename)
-    , _stopForceUpdate(false)
 {
     if (!std::filesystem::exists(filename)) {
         throw std::runtime_error("Cannot find status file: " + filename.string() + ". Did you lanch the game previously?");
@@ -16,17 +15,13 @@ StatusWatcher::StatusWatcher(
 
     std::wcout << L"[INFO  ] Monitoring: " << filename << std::endl;
 
-    _previousFlags = getFlags();
+    StatusSnapshot snapshot;
+    readStatus(_previousFlags, snapshot);
 }
 
 
 StatusWatcher::~StatusWatcher()
 {
-    _stopForceUpdate = true;
-    
-    if (_forcedUpdateThread.joinable()) {
-        _forcedUpdateThread.join();
-    }
 }
 
 
@@ -36,43 +31,179 @@ void StatusWatcher::addListener(StatusListener* listener)
 }
 
 
-void StatusWatcher::start()
+void StatusWatcher::addFieldListener(StatusFieldListener* listener, StatusFieldMask fields)
+{
+    _fieldListeners.push_back({ listener, fields });
+
+    if (!_decodeFields) {
+        _decodeFields = true;
+        // Decode the current content on next update to get a reference snapshot
+        _contentHash = 0;
+    }
+}
+
+
+void StatusWatcher::addThreshold(StatusFieldListener* listener, const StatusThreshold& threshold)
 {
-    _forcedUpdateThread = std::thread(&StatusWatcher::forcedUpdate, this);
+    _thresholds.push_back({ listener, threshold });
+    addFieldListener(listener, 0);
 }
 
 
-void StatusWatcher::update()
+void StatusWatcher::update(LatencyTrace::Clock::time_point wakeTime)
 {
-    checkUpdatedBits(getFlags());
+    StatusFlags flags = 0;
+    StatusSnapshot snapshot;
+
+    if (readStatus(flags, snapshot)) {
+        LatencyTrace trace;
+        trace.stamp(Wake, wakeTime);
+        trace.stamp(Parsed);
+
+        checkUpdatedBits(flags, trace);
+
+        if (_decodeFields) {
+            checkUpdatedFields(snapshot);
+        }
+    }
 }
 
 
-uint32_t StatusWatcher::getFlags() const
+bool StatusWatcher::readStatus(StatusFlags& flags, StatusSnapshot& snapshot)
 {
-    std::ifstream file(_statusFile, std::ios::in);
-    nlohmann::json j;
-    std::string line;
-    uint32_t currentFlags = 0;
+    if (!_file.isOpen() && !_file.open(_statusFile)) {
+        return false;
+    }
+
+    const int64_t bytesRead = _file.readAt(0, _buffer.data(), _buffer.size());
+
+    if (bytesRead < 0) {
+        // Reopen on next update
+        _file.close();
+        return false;
+    }
+
+    // Empty while the game rewrites it, or unexpectedly large
+    if (bytesRead == 0 || (size_t)bytesRead == _buffer.size()) {
+        return false;
+    }
+
+    const std::string_view content(_buffer.data(), (size_t)bytesRead);
+
+    // Partially written, the missing fields would be seen as changes
+    const size_t last = content.find_last_not_of(" \t\r\n");
 
-    if (std::getline(file, line)) {
-        try {
-            auto j = nlohmann::json::parse(line);
+    if (last == std::string_view::npos || content[last] != '}') {
+        return false;
+    }
+
+    const uint64_t hash = hashContent(content);
 
-            if (j["Flags"].is_number_integer()) {
-                currentFlags = j["Flags"].get<uint32_t>();
+    if (hash == _contentHash) {
+        return false;
+    }
+
+    std::optional<uint64_t> value, value2;
+    JsonScanner scanner(content);
+    std::string_view key, rawValue;
+
+    // Single pass over the members
+    while (scanner.nextMember(key, rawValue)) {
+        if (key == "Flags") {
+            value = JsonScanner::toUnsigned(rawValue);
+            if (!value) {
+                return false;
+            }
+        }
+        else if (key == "Flags2") {
+            value2 = JsonScanner::toUnsigned(rawValue);
+            if (!value2) {
+                return false;
             }
         }
-        catch (std::exception& e) {
-            std::cerr << "ERR JSON: " << e.what() << "\n";
+        else if (_decodeFields && !decodeField(key, rawValue, snapshot)) {
+            return false;
         }
     }
 
-    return currentFlags;
+    if (!value) {
+        return false;
+    }
+
+    _contentHash = hash;
+    // Flags2 is only written by Odyssey
+    flags = StatusEventUtil::toFlags((uint32_t)*value, (uint32_t)value2.value_or(0));
+
+    return true;
 }
 
 
-void StatusWatcher::checkUpdatedBits(uint32_t flags)
+bool StatusWatcher::decodeField(std::string_view key, std::string_view rawValue, StatusSnapshot& snapshot)
+{
+    if (key == "Fuel") {
+        JsonScanner fuel(rawValue);
+        std::string_view fuelKey, fuelValue;
+
+        while (fuel.nextMember(fuelKey, fuelValue)) {
+            if (!decodeField(fuelKey, fuelValue, snapshot)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    if (key == "Pips") {
+        JsonScanner pips(rawValue);
+        std::string_view pipValue;
+
+        for (int i = PipsSys; i <= PipsWep && pips.nextElement(pipValue); i++) {
+            const std::optional<double> value = JsonScanner::toNumber(pipValue);
+
+            if (!value) {
+                return false;
+            }
+
+            snapshot.set((StatusField)i, *value);
+        }
+
+        return true;
+    }
+
+    const std::optional<StatusField> field = StatusFieldUtil::fromString(key);
+
+    // Strings (LegalState, BodyName...) and unknown members are skipped
+    if (!field) {
+        return true;
+    }
+
+    const std::optional<double> value = JsonScanner::toNumber(rawValue);
+
+    if (!value) {
+        return false;
+    }
+
+    snapshot.set(*field, *value);
+
+    return true;
+}
+
+
+uint64_t StatusWatcher::hashContent(std::string_view content)
+{
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (const char c : content) {
+        hash ^= (uint8_t)c;
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+
+void StatusWatcher::checkUpdatedBits(StatusFlags flags, const LatencyTrace& trace)
 {
     // ignore 0
     if (!flags || flags == _previousFlags) {
@@ -87,73 +218,87 @@ void StatusWatcher::checkUpdatedBits(uint32_t flags)
 
     printChangedBits(flags);
 
-    for (int i_bit = 0; i_bit < 32; i_bit++) {
-        const bool prevStatusBit = _previousFlags & (1 << i_bit);
-        const bool currStatusBit = flags & (1 << i_bit);
+    const StatusFlags changedMask = (flags ^ _previousFlags) & StatusEventUtil::knownMask();
+    _previousFlags = flags;
 
-        // Skip it if we already know the status
-        if (prevStatusBit != currStatusBit) {
-            for (StatusListener* listener : _listeners) {
-                listener->onStatusChanged((StatusEvent)i_bit, currStatusBit);
-            }
-        }
+    if (!changedMask) {
+        return;
     }
 
-    _previousFlags = flags;
+    for (StatusListener* listener : _listeners) {
+        listener->onStatusChanged(flags, changedMask, trace);
+    }
 }
 
 
-void StatusWatcher::printChangedBits(uint32_t flags)
+void StatusWatcher::printChangedBits(StatusFlags flags)
 {
     std::cout << "[STATUS] Previous flags ";
 
-    for (int i_bit = 0; i_bit < 32; i_bit++) {
-        const bool prevStatusBit = _previousFlags & (1 << i_bit);
-        if (prevStatusBit) {
-            std::cout << 1;
-        }
-        else {
-            std::cout << 0;
-        }
+    for (int i_bit = 0; i_bit < N_StatusEvents; i_bit++) {
+        std::cout << ((_previousFlags >> i_bit) & 1);
     }
     std::cout << std::endl;
 
     std::cout << "[STATUS] Current flags  ";
 
-    for (int i_bit = 0; i_bit < 32; i_bit++) {
-        const bool currStatusBit = flags & (1 << i_bit);
-        if (currStatusBit) {
-            std::cout << 1;
-        }
-        else {
-            std::cout << 0;
-        }
+    for (int i_bit = 0; i_bit < N_StatusEvents; i_bit++) {
+        std::cout << ((flags >> i_bit) & 1);
     }
     std::cout << std::endl;
 
     std::cout << "[STATUS]                ";
 
-    for (int i_bit = 0; i_bit < 32; i_bit++) {
-        const bool prevStatusBit = _previousFlags & (1 << i_bit);
-        const bool currStatusBit = flags & (1 << i_bit);
+    const StatusFlags changedMask = flags ^ _previousFlags;
 
-        // Skip it if we already know the status
-        if (prevStatusBit != currStatusBit) {
-            std::cout << "x";
-        }
-        else {
-            std::cout << " ";
-        }
+    for (int i_bit = 0; i_bit < N_StatusEvents; i_bit++) {
+        std::cout << (((changedMask >> i_bit) & 1) ? 'x' : ' ');
     }
     std::cout << std::endl;
 }
 
 
-void StatusWatcher::forcedUpdate() {
-    // We need to regularly load the file to avoid miss in the WIN32 monitoring
-    // in case the file was not flushed to the disk.
-    while (!_stopForceUpdate) {
-        std::wifstream file(_statusFile, std::ios::in | std::ios::binary);
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+void StatusWatcher::checkUpdatedFields(const StatusSnapshot& snapshot)
+{
+    // First decode, just store the snapshot
+    if (!_hasSnapshot) {
+        _previousSnapshot = snapshot;
+        _hasSnapshot = true;
+        return;
+    }
+
+    // Fields appearing or disappearing are changes too
+    StatusFieldMask changedMask = _previousSnapshot.present ^ snapshot.present;
+    const StatusFieldMask presentMask = _previousSnapshot.present & snapshot.present;
+
+    for (int i = 0; i < N_StatusFields; i++) {
+        if ((presentMask & StatusFieldUtil::toMask((StatusField)i)) &&
+            _previousSnapshot.values[i] != snapshot.values[i]) {
+            changedMask |= StatusFieldUtil::toMask((StatusField)i);
+        }
     }
+
+    if (!changedMask) {
+        return;
+    }
+
+    for (const FieldSubscription& subscription : _fieldListeners) {
+        const StatusFieldMask fields = changedMask & subscription.fields;
+
+        if (fields) {
+            subscription.listener->onStatusFieldsChanged(_previousSnapshot, snapshot, fields);
+        }
+    }
+
+    for (const ThresholdSubscription& subscription : _thresholds) {
+        const StatusThreshold& threshold = subscription.threshold;
+
+        if ((changedMask & StatusFieldUtil::toMask(threshold.field)) &&
+            threshold.isReached(snapshot) &&
+            !threshold.isReached(_previousSnapshot)) {
+            subscription.listener->onStatusThreshold(threshold, snapshot.values[threshold.field]);
+        }
+    }
+
+    _previousSnapshot = snapshot;
 }
\ No newline at end of file
@@ -1,18 +1,33 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <filesystem>
+#include <string_view>
 #include <vector>
-#include <thread>
-#include <atomic>
 
 #include "StatusEvent.h"
+#include "StatusField.h"
+#include "../util/FileReader.h"
+#include "../util/LatencyTrace.h"
 
 
 class StatusListener
 {
 public:
-    virtual void onStatusChanged(StatusEvent event, bool set) = 0;
+    // Called once per update with all the bits that changed.
+    // The trace holds the wake and parse times of the update.
+    virtual void onStatusChanged(StatusFlags flags, StatusFlags changedMask, const LatencyTrace& trace) = 0;
+};
+
+
+class StatusFieldListener
+{
+public:
+    // changedMask only contains the fields the listener subscribed to
+    virtual void onStatusFieldsChanged(const StatusSnapshot& previous, const StatusSnapshot& current, StatusFieldMask changedMask) {}
+
+    virtual void onStatusThreshold(const StatusThreshold& threshold, double value) {}
 };
 
 
@@ -24,26 +39,55 @@ public:
     
     void addListener(StatusListener* listener);
 
-    void start();
+    // Field subscriptions enable the decoding of the whole Status.json
+    void addFieldListener(StatusFieldListener* listener, StatusFieldMask fields);
+    void addThreshold(StatusFieldListener* listener, const StatusThreshold& threshold);
 
-    void update();
+    // wakeTime: when the file watcher was woken up, for latency tracing
+    void update(LatencyTrace::Clock::time_point wakeTime);
 
 private:
-    uint32_t getFlags() const;
+    // Returns false when the file did not change or is being rewritten
+    bool readStatus(StatusFlags& flags, StatusSnapshot& snapshot);
 
-    void checkUpdatedBits(uint32_t flags);
+    static bool decodeField(std::string_view key, std::string_view rawValue, StatusSnapshot& snapshot);
 
-    void printChangedBits(uint32_t flags);
+    static uint64_t hashContent(std::string_view content);
 
-private:
-    void forcedUpdate();
+    void checkUpdatedBits(StatusFlags flags, const LatencyTrace& trace);
+
+    void printChangedBits(StatusFlags flags);
+
+    void checkUpdatedFields(const StatusSnapshot& snapshot);
 
 private:
+    // Status.json is a single line of a few hundred bytes
+    static constexpr size_t STATUS_BUFFER_SIZE = 8192;
+
     const std::filesystem::path _statusFile;
-    uint32_t _previousFlags;
+    StatusFlags _previousFlags = 0;
+
+    // Kept open, the file is read several times per second while flying
+    FileReader _file;
+    std::array<char, STATUS_BUFFER_SIZE> _buffer;
+    uint64_t _contentHash = 0;
 
     std::vector<StatusListener*> _listeners;
 
-    std::atomic<bool> _stopForceUpdate;
-    std::thread _forcedUpdateThread;
+    struct FieldSubscription {
+        StatusFieldListener* listener;
+        StatusFieldMask fields;
+    };
+
+    struct ThresholdSubscription {
+        StatusFieldListener* listener;
+        StatusThreshold threshold;
+    };
+
+    std::vector<FieldSubscription> _fieldListeners;
+    std::vector<ThresholdSubscription> _thresholds;
+    bool _decodeFields = false;
+
+    StatusSnapshot _previousSnapshot;
+    bool _hasSnapshot = false;
 };